@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "output.h"
+
+#define BENCH_VALUES 65536
+#define BENCH_ROUNDS 100
+#define VERIFY_RANDOM 2000000
+
+/*
+ * The floating-point/snprintf formatters this tree used before the
+ * fixed-point kernels, kept verbatim as the reference and baseline
+ */
+static void legacy_format_bytes(uint64_t bytes, char *buffer, size_t bufsize) {
+    const char *units[] = {"B", "KB", "MB", "GB", "TB"};
+    int unit_idx = 0;
+    double value = (double)bytes;
+
+    while (value >= 1024.0 && unit_idx < 4) {
+        value /= 1024.0;
+        unit_idx++;
+    }
+
+    if (unit_idx == 0) {
+        snprintf(buffer, bufsize, "%llu %s", (unsigned long long)bytes, units[unit_idx]);
+    } else {
+        snprintf(buffer, bufsize, "%.1f %s", value, units[unit_idx]);
+    }
+}
+
+static void legacy_format_rate(double rate, char *buffer, size_t bufsize) {
+    const char *units[] = {"B/s", "KB/s", "MB/s", "GB/s"};
+    int unit_idx = 0;
+    double value = rate;
+
+    while (value >= 1024.0 && unit_idx < 3) {
+        value /= 1024.0;
+        unit_idx++;
+    }
+
+    if (rate < 1.0) {
+        snprintf(buffer, bufsize, "0 B/s");
+    } else if (unit_idx == 0) {
+        snprintf(buffer, bufsize, "%.0f %s", value, units[unit_idx]);
+    } else {
+        snprintf(buffer, bufsize, "%.1f %s", value, units[unit_idx]);
+    }
+}
+
+static uint64_t next_random(uint64_t *seed) {
+    *seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return *seed ^ (*seed >> 29);
+}
+
+static bool check_bytes(uint64_t bytes) {
+    char a[32], b[32];
+    legacy_format_bytes(bytes, a, sizeof(a));
+    format_bytes(bytes, b, sizeof(b));
+    if (strcmp(a, b) != 0) {
+        fprintf(stderr, "format_bytes(%llu): \"%s\" != \"%s\"\n",
+                (unsigned long long)bytes, b, a);
+        return false;
+    }
+    return true;
+}
+
+static bool check_rate(double rate) {
+    char a[32], b[32];
+    legacy_format_rate(rate, a, sizeof(a));
+    format_rate(rate, b, sizeof(b));
+    if (strcmp(a, b) != 0) {
+        fprintf(stderr, "format_rate(%.17g): \"%s\" != \"%s\"\n", rate, b, a);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Compare against the reference on unit boundaries, rounding ties,
+ * special values and a large random sample of every magnitude
+ */
+static bool verify(void) {
+    uint64_t seed = 0x9e3779b97f4a7c15ULL;
+
+    for (int unit = 0; unit <= 6; unit++) {
+        uint64_t base = unit < 6 ? UINT64_C(1) << (10 * unit) : UINT64_MAX / 2;
+        for (uint64_t d = 0; d < 4096; d++) {
+            if (!check_bytes(base + d) || (base > d && !check_bytes(base - d))) {
+                return false;
+            }
+            /* x.x5 ties and their neighbours */
+            double tie = ((double)d + 0.5) / 10.0 * (double)base;
+            if (!check_rate(tie) || !check_rate(nextafter(tie, 0.0)) ||
+                !check_rate(nextafter(tie, INFINITY)) || !check_rate((double)(base + d)) ||
+                !check_rate((double)d + 0.5)) {
+                return false;
+            }
+        }
+    }
+
+    const double specials[] = {0.0, -1.0, 0.5, 0.999999, 1.0, 1023.5, 1024.0,
+                               9007199254740991.0, 9007199254740992.0, 1e300,
+                               INFINITY, NAN};
+    for (size_t i = 0; i < sizeof(specials) / sizeof(specials[0]); i++) {
+        if (!check_rate(specials[i])) {
+            return false;
+        }
+    }
+    if (!check_bytes(UINT64_MAX) || !check_bytes(UINT64_C(1) << 53)) {
+        return false;
+    }
+
+    for (int i = 0; i < VERIFY_RANDOM; i++) {
+        uint64_t r = next_random(&seed);
+        uint64_t bytes = r >> (r % 64);
+        double rate = ldexp((double)(next_random(&seed) >> 11), (int)(r % 80) - 53);
+        if (!check_bytes(bytes) || !check_rate(rate)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+typedef void (*bytes_fn)(uint64_t bytes, char *buffer, size_t bufsize);
+typedef void (*rate_fn)(double rate, char *buffer, size_t bufsize);
+
+static double time_bytes(bytes_fn fn, const uint64_t *values, unsigned *checksum) {
+    char buffer[32];
+    unsigned sum = 0;
+    double start = now_seconds();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (size_t i = 0; i < BENCH_VALUES; i++) {
+            fn(values[i], buffer, sizeof(buffer));
+            sum += (unsigned char)buffer[1];
+        }
+    }
+    *checksum = sum;
+    return (now_seconds() - start) * 1e9 / ((double)BENCH_VALUES * BENCH_ROUNDS);
+}
+
+static double time_rate(rate_fn fn, const double *values, unsigned *checksum) {
+    char buffer[32];
+    unsigned sum = 0;
+    double start = now_seconds();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (size_t i = 0; i < BENCH_VALUES; i++) {
+            fn(values[i], buffer, sizeof(buffer));
+            sum += (unsigned char)buffer[1];
+        }
+    }
+    *checksum = sum;
+    return (now_seconds() - start) * 1e9 / ((double)BENCH_VALUES * BENCH_ROUNDS);
+}
+
+int main(void) {
+    static uint64_t byte_values[BENCH_VALUES];
+    static double rate_values[BENCH_VALUES];
+    uint64_t seed = 0x2545f4914f6cdd1dULL;
+
+    if (!verify()) {
+        return EXIT_FAILURE;
+    }
+
+    /* Counter totals from bytes to terabytes, rates from idle to 100 Gbit/s */
+    for (size_t i = 0; i < BENCH_VALUES; i++) {
+        uint64_t r = next_random(&seed);
+        byte_values[i] = r >> (20 + r % 44);
+        rate_values[i] = ldexp((double)(next_random(&seed) >> 11), (int)(r % 34) - 53);
+    }
+
+    unsigned sum_legacy, sum_fixed;
+    double bytes_legacy = time_bytes(legacy_format_bytes, byte_values, &sum_legacy);
+    double bytes_fixed = time_bytes(format_bytes, byte_values, &sum_fixed);
+    if (sum_legacy != sum_fixed) {
+        fprintf(stderr, "Checksum mismatch\n");
+        return EXIT_FAILURE;
+    }
+    double rate_legacy = time_rate(legacy_format_rate, rate_values, &sum_legacy);
+    double rate_fixed = time_rate(format_rate, rate_values, &sum_fixed);
+    if (sum_legacy != sum_fixed) {
+        fprintf(stderr, "Checksum mismatch\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("Unit formatting: output identical to snprintf on %d random values and edge cases\n",
+           VERIFY_RANDOM);
+    printf("%-14s %14s %14s %10s\n", "Function", "snprintf (ns)", "fixed (ns)", "Speedup");
+    printf("%-14s %14.1f %14.1f %9.1fx\n", "format_bytes",
+           bytes_legacy, bytes_fixed, bytes_legacy / bytes_fixed);
+    printf("%-14s %14.1f %14.1f %9.1fx\n", "format_rate",
+           rate_legacy, rate_fixed, rate_legacy / rate_fixed);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "netstat_monitor.h"
+#include "iface_table.h"
+#include "procfs.h"
+
+#define BENCH_IFACES 5000
+#define BENCH_ROUNDS 200
+#define BENCH_REPEATS 5
+
+static const size_t watched_counts[] = {1, 4, 16, 256, BENCH_IFACES};
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * A /proc/net/dev with BENCH_IFACES container-style interfaces
+ */
+static char *build_proc_net_dev(size_t *len) {
+    size_t cap = 256 + (size_t)BENCH_IFACES * 128;
+    char *buf = malloc(cap);
+    if (!buf) {
+        return NULL;
+    }
+    size_t n = (size_t)snprintf(buf, cap,
+        "Inter-|   Receive                                                |  Transmit\n"
+        " face |bytes    packets errs drop fifo frame compressed multicast|"
+        "bytes    packets errs drop fifo colls carrier compressed\n");
+    for (size_t i = 0; i < BENCH_IFACES; i++) {
+        n += (size_t)snprintf(buf + n, cap - n,
+                              "veth%05zu: %zu %zu 0 0 0 0 0 0 %zu %zu 0 0 0 0 0 0\n",
+                              i, i * 1500, i, i * 3000, i * 2);
+    }
+    *len = n;
+    return buf;
+}
+
+/**
+ * The linear search every line used to pay, for comparison
+ */
+static iface_slot_t *linear_find(iface_table_t *table, const char *name, size_t len) {
+    for (size_t i = 0; i < table->count; i++) {
+        const char *slot_name = table->slots[i].current.interface;
+        if (slot_name[len] == '\0' && memcmp(slot_name, name, len) == 0) {
+            return &table->slots[i];
+        }
+    }
+    return NULL;
+}
+
+static void linear_parse(const char *buf, iface_table_t *table) {
+    const procfs_scanner_t *scanner = &procfs_scanner_scalar;
+    const char *line = buf;
+    for (int i = 0; i < 2; i++) {
+        line = scanner->line_end(line) + 1;
+    }
+    while (*line) {
+        size_t name_len;
+        const char *fields;
+        const char *eol = NULL;
+        const char *name = scanner->line_name(line, &name_len, &fields);
+        if (name && name_len < MAX_IFACE_LEN) {
+            iface_slot_t *slot = linear_find(table, name, name_len);
+            if (slot) {
+                eol = scanner->parse_counters(fields, &slot->current);
+                slot->seen = (eol != NULL);
+            }
+        }
+        if (!eol) {
+            eol = scanner->line_end(name ? fields : line);
+        }
+        line = *eol ? eol + 1 : eol;
+    }
+}
+
+int main(void) {
+    size_t len;
+    char *buf = build_proc_net_dev(&len);
+    if (!buf) {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+    bool ok = true;
+
+    printf("%d interfaces, best of %d x %d rounds, scalar scanner\n", BENCH_IFACES,
+           BENCH_REPEATS, BENCH_ROUNDS);
+    printf("%-8s %16s %16s\n", "Watched", "linear (us)", "hashed (us)");
+
+    for (size_t w = 0; w < sizeof(watched_counts) / sizeof(watched_counts[0]) && ok; w++) {
+        iface_table_t table = {0};
+        char name[MAX_IFACE_LEN];
+        /* Spread the watched names over the file */
+        size_t step = BENCH_IFACES / watched_counts[w];
+        for (size_t i = 0; i < watched_counts[w]; i++) {
+            snprintf(name, sizeof(name), "veth%05zu", i * step);
+            if (!iface_table_add(&table, name)) {
+                ok = false;
+                break;
+            }
+        }
+
+        procfs_parse_buffer(&procfs_scanner_scalar, buf, &table);
+        for (size_t i = 0; i < table.count && ok; i++) {
+            if (!table.slots[i].seen || table.slots[i].current.rx_packets != i * step) {
+                fprintf(stderr, "Lookup mismatch on %s\n", table.slots[i].current.interface);
+                ok = false;
+            }
+        }
+
+        /* Best of BENCH_REPEATS, alternating, so that noise hits both alike */
+        double us[2] = {0.0, 0.0};
+        for (int repeat = 0; repeat < BENCH_REPEATS && ok; repeat++) {
+            for (int hashed = 0; hashed < 2; hashed++) {
+                double start = now_seconds();
+                for (int round = 0; round < BENCH_ROUNDS; round++) {
+                    if (hashed) {
+                        procfs_parse_buffer(&procfs_scanner_scalar, buf, &table);
+                    } else {
+                        iface_table_begin_sample(&table);
+                        linear_parse(buf, &table);
+                    }
+                }
+                double elapsed = (now_seconds() - start) / BENCH_ROUNDS * 1e6;
+                if (repeat == 0 || elapsed < us[hashed]) {
+                    us[hashed] = elapsed;
+                }
+            }
+        }
+        if (ok) {
+            printf("%-8zu %16.1f %16.1f\n", watched_counts[w], us[0], us[1]);
+        }
+        iface_table_free(&table);
+    }
+
+    free(buf);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "netstat_monitor.h"
+#include "output.h"
+#include "rate.h"
+#include "timestamp.h"
+
+#define BENCH_IFACES 64
+#define BENCH_TICKS 2000
+
+/*
+ * The snprintf/printf row path this tree used before the batched writer,
+ * kept verbatim apart from writing to fp, as the baseline to beat
+ */
+static void legacy_format_bytes(uint64_t bytes, char *buffer, size_t bufsize) {
+    const char *units[] = {"B", "KB", "MB", "GB", "TB"};
+    int unit_idx = 0;
+    double value = (double)bytes;
+
+    while (value >= 1024.0 && unit_idx < 4) {
+        value /= 1024.0;
+        unit_idx++;
+    }
+
+    if (unit_idx == 0) {
+        snprintf(buffer, bufsize, "%llu %s", (unsigned long long)bytes, units[unit_idx]);
+    } else {
+        snprintf(buffer, bufsize, "%.1f %s", value, units[unit_idx]);
+    }
+}
+
+static void legacy_format_rate(double rate, char *buffer, size_t bufsize) {
+    const char *units[] = {"B/s", "KB/s", "MB/s", "GB/s"};
+    int unit_idx = 0;
+    double value = rate;
+
+    while (value >= 1024.0 && unit_idx < 3) {
+        value /= 1024.0;
+        unit_idx++;
+    }
+
+    if (rate < 1.0) {
+        snprintf(buffer, bufsize, "0 B/s");
+    } else if (unit_idx == 0) {
+        snprintf(buffer, bufsize, "%.0f %s", value, units[unit_idx]);
+    } else {
+        snprintf(buffer, bufsize, "%.1f %s", value, units[unit_idx]);
+    }
+}
+
+static void legacy_print_stats(FILE *fp, const net_stats_t *current, const net_stats_t *previous,
+                               double elapsed) {
+    char timestamp[32];
+    time_t now = time(NULL);
+    struct tm *tm_info = localtime(&now);
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", tm_info);
+
+    char rx_bytes_str[32], tx_bytes_str[32];
+    legacy_format_bytes(current->rx_bytes, rx_bytes_str, sizeof(rx_bytes_str));
+    legacy_format_bytes(current->tx_bytes, tx_bytes_str, sizeof(tx_bytes_str));
+
+    char rx_rate_str[32] = "-", tx_rate_str[32] = "-";
+    char rx_pkt_rate_str[32] = "-", tx_pkt_rate_str[32] = "-";
+
+    if (previous && previous->valid) {
+        uint64_t rx_delta = safe_delta(current->rx_bytes, previous->rx_bytes);
+        uint64_t tx_delta = safe_delta(current->tx_bytes, previous->tx_bytes);
+        uint64_t rx_pkt_delta = safe_delta(current->rx_packets, previous->rx_packets);
+        uint64_t tx_pkt_delta = safe_delta(current->tx_packets, previous->tx_packets);
+
+        double rx_rate = calculate_rate(rx_delta, elapsed);
+        double tx_rate = calculate_rate(tx_delta, elapsed);
+        double rx_pkt_rate = calculate_rate(rx_pkt_delta, elapsed);
+        double tx_pkt_rate = calculate_rate(tx_pkt_delta, elapsed);
+
+        legacy_format_rate(rx_rate, rx_rate_str, sizeof(rx_rate_str));
+        legacy_format_rate(tx_rate, tx_rate_str, sizeof(tx_rate_str));
+        snprintf(rx_pkt_rate_str, sizeof(rx_pkt_rate_str), "%.0f", rx_pkt_rate);
+        snprintf(tx_pkt_rate_str, sizeof(tx_pkt_rate_str), "%.0f", tx_pkt_rate);
+    }
+
+    fprintf(fp, "%-19s %-10s %15s %12s %10llu %10s %8llu %8llu %15s %12s %10llu %10s %8llu %8llu\n",
+            timestamp, current->interface,
+            rx_bytes_str, rx_rate_str,
+            (unsigned long long)current->rx_packets, rx_pkt_rate_str,
+            (unsigned long long)current->rx_errors,
+            (unsigned long long)current->rx_drops,
+            tx_bytes_str, tx_rate_str,
+            (unsigned long long)current->tx_packets, tx_pkt_rate_str,
+            (unsigned long long)current->tx_errors,
+            (unsigned long long)current->tx_drops);
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * Fill consecutive samples per interface with counters of every magnitude
+ * and rates from idle to tens of GB/s
+ */
+static void build_samples(net_stats_t (*prev)[BENCH_IFACES], net_stats_t (*cur)[BENCH_IFACES],
+                          double *elapsed, size_t ticks) {
+    uint64_t seed = 0x9e3779b97f4a7c15ULL;
+    for (size_t t = 0; t < ticks; t++) {
+        elapsed[t] = 0.5 + (double)(t % 7) * 0.25;
+        for (size_t i = 0; i < BENCH_IFACES; i++) {
+            net_stats_t *p = &prev[t][i];
+            net_stats_t *c = &cur[t][i];
+            uint64_t *pv = &p->rx_bytes;
+            memset(p, 0, sizeof(*p));
+            snprintf(p->interface, sizeof(p->interface), i % 9 ? "veth%zu" : "bond%zu.1000", i);
+            /* rx_bytes .. tx_drops are consecutive uint64_t fields */
+            for (int f = 0; f < 8; f++) {
+                seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+                pv[f] = seed >> (seed % 64);
+            }
+            *c = *p;
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            c->rx_bytes += seed >> (20 + seed % 44);
+            c->tx_bytes += seed >> (24 + seed % 40);
+            c->rx_packets += seed >> (32 + seed % 32);
+            c->tx_packets += (seed >> 8) % 100000;
+            p->valid = (i + t) % 17 != 0;
+            c->valid = true;
+        }
+    }
+}
+
+static bool verify(net_stats_t (*prev)[BENCH_IFACES], net_stats_t (*cur)[BENCH_IFACES],
+                   const double *elapsed, size_t ticks) {
+    char *legacy = NULL;
+    size_t legacy_size = 0;
+    FILE *fp = open_memstream(&legacy, &legacy_size);
+    output_t out;
+    timestamp_cache_t clock;
+    bool ok = true;
+
+    timestamp_cache_init(&clock, false);
+
+    if (!fp || !output_init(&out, -1, TIMESTAMP_WIDTH)) {
+        fprintf(stderr, "Error: Cannot set up verification buffers: %s\n", strerror(errno));
+        return false;
+    }
+
+    for (size_t t = 0; t < ticks && ok; t++) {
+        for (size_t i = 0; i < BENCH_IFACES && ok; i++) {
+            size_t start = legacy_size;
+            legacy_print_stats(fp, &cur[t][i], &prev[t][i], elapsed[t]);
+            fflush(fp);
+
+            out.len = 0;
+            output_stats_row(&out, timestamp_now(&clock), &cur[t][i], &prev[t][i], elapsed[t]);
+
+            /* The clock may tick between the two rows, so skip the timestamp */
+            size_t len = legacy_size - start;
+            if (len != out.len || memcmp(legacy + start + TIMESTAMP_WIDTH,
+                                         out.buf + TIMESTAMP_WIDTH, len - TIMESTAMP_WIDTH) != 0) {
+                fprintf(stderr, "Mismatch:\n%.*s%.*s", (int)len, legacy + start,
+                        (int)out.len, out.buf);
+                ok = false;
+            }
+        }
+    }
+
+    fclose(fp);
+    free(legacy);
+    output_free(&out);
+    return ok;
+}
+
+int main(void) {
+    static net_stats_t prev[BENCH_TICKS][BENCH_IFACES];
+    static net_stats_t cur[BENCH_TICKS][BENCH_IFACES];
+    static double elapsed[BENCH_TICKS];
+    const double rows = (double)BENCH_TICKS * BENCH_IFACES;
+
+    build_samples(prev, cur, elapsed, BENCH_TICKS);
+    if (!verify(prev, cur, elapsed, BENCH_TICKS)) {
+        return EXIT_FAILURE;
+    }
+
+    int fd = open("/dev/null", O_WRONLY);
+    FILE *fp = fopen("/dev/null", "w");
+    output_t out;
+    timestamp_cache_t clock;
+    timestamp_cache_init(&clock, false);
+    if (fd < 0 || !fp || !output_init(&out, fd, TIMESTAMP_WIDTH)) {
+        fprintf(stderr, "Error: Cannot open /dev/null: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    double start = now_seconds();
+    for (size_t t = 0; t < BENCH_TICKS; t++) {
+        for (size_t i = 0; i < BENCH_IFACES; i++) {
+            legacy_print_stats(fp, &cur[t][i], &prev[t][i], elapsed[t]);
+        }
+        fflush(fp);
+    }
+    double legacy = rows / (now_seconds() - start);
+
+    start = now_seconds();
+    for (size_t t = 0; t < BENCH_TICKS; t++) {
+        /* One cached timestamp per tick, as the monitor does */
+        const char *timestamp = timestamp_now(&clock);
+        for (size_t i = 0; i < BENCH_IFACES; i++) {
+            output_stats_row(&out, timestamp, &cur[t][i], &prev[t][i], elapsed[t]);
+        }
+        output_flush(&out);
+    }
+    double batched = rows / (now_seconds() - start);
+
+    start = now_seconds();
+    for (size_t t = 0; t < BENCH_TICKS; t++) {
+        struct timespec wall;
+        clock_gettime(CLOCK_REALTIME, &wall);
+        for (size_t i = 0; i < BENCH_IFACES; i++) {
+            output_json_row(&out, &wall, &cur[t][i], &prev[t][i], elapsed[t]);
+        }
+        output_flush(&out);
+    }
+    double json = rows / (now_seconds() - start);
+
+    printf("Row output: %d interfaces x %d ticks, flushed once per tick\n",
+           BENCH_IFACES, BENCH_TICKS);
+    printf("%-10s %14s %10s\n", "Path", "Rows/s", "Speedup");
+    printf("%-10s %14.0f %9.1fx\n", "printf", legacy, 1.0);
+    printf("%-10s %14.0f %9.1fx\n", "batched", batched, batched / legacy);
+    printf("%-10s %14.0f %9.1fx\n", "json", json, json / legacy);
+
+    fclose(fp);
+    close(fd);
+    output_free(&out);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "netstat_monitor.h"
+#include "procfs.h"
+
+#define MAX_LINE_LEN 1024
+#define BENCH_LINES 4096
+#define BENCH_ROUNDS 200
+
+typedef bool (*parse_fn)(const char *line, const char *interface, net_stats_t *stats);
+
+/**
+ * The strncpy/strtok_r/strtoull parser this tree used before the
+ * single-pass tokenizer, kept verbatim as the baseline to beat
+ */
+static bool legacy_parse_interface_line(const char *line, const char *interface, net_stats_t *stats) {
+    char iface_name[MAX_IFACE_LEN];
+    char line_copy[MAX_LINE_LEN];
+
+    strncpy(line_copy, line, sizeof(line_copy) - 1);
+    line_copy[sizeof(line_copy) - 1] = '\0';
+
+    char *colon = strchr(line_copy, ':');
+    if (!colon) {
+        return false;
+    }
+
+    *colon = '\0';
+    const char *iface_start = line_copy;
+    while (*iface_start == ' ' || *iface_start == '\t') {
+        iface_start++;
+    }
+
+    strncpy(iface_name, iface_start, sizeof(iface_name) - 1);
+    iface_name[sizeof(iface_name) - 1] = '\0';
+
+    size_t len = strlen(iface_name);
+    while (len > 0 && (iface_name[len - 1] == ' ' || iface_name[len - 1] == '\t')) {
+        iface_name[--len] = '\0';
+    }
+
+    if (interface && strcmp(iface_name, interface) != 0) {
+        return false;
+    }
+
+    char *token_ptr = colon + 1;
+    char *saveptr = NULL;
+    unsigned long long values[16];
+    int token_count = 0;
+
+    char *token = strtok_r(token_ptr, " \t\n\r", &saveptr);
+    while (token && token_count < 16) {
+        char *endptr;
+        errno = 0;
+        values[token_count] = strtoull(token, &endptr, 10);
+
+        if (errno != 0 || *endptr != '\0') {
+            return false;
+        }
+        
+        token_count++;
+        token = strtok_r(NULL, " \t\n\r", &saveptr);
+    }
+
+    if (token_count < 16) {
+        return false;
+    }
+
+    strncpy(stats->interface, iface_name, sizeof(stats->interface) - 1);
+    stats->interface[sizeof(stats->interface) - 1] = '\0';
+    stats->rx_bytes = values[0];
+    stats->rx_packets = values[1];
+    stats->rx_errors = values[2];
+    stats->rx_drops = values[3];
+    stats->tx_bytes = values[8];
+    stats->tx_packets = values[9];
+    stats->tx_errors = values[10];
+    stats->tx_drops = values[11];
+
+    stats->valid = true;
+    return true;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * Fill lines with /proc/net/dev-style rows for veth00000..vethNNNNN,
+ * with counter widths ranging from 1 to 20 digits
+ */
+static void build_lines(char (*lines)[MAX_LINE_LEN], char (*names)[MAX_IFACE_LEN], size_t count) {
+    uint64_t seed = 0x9e3779b97f4a7c15ULL;
+    for (size_t i = 0; i < count; i++) {
+        snprintf(names[i], MAX_IFACE_LEN, "veth%05zu", i);
+        int len = snprintf(lines[i], MAX_LINE_LEN, "%*s:", 16, names[i]);
+        for (int f = 0; f < PROC_NET_DEV_FIELDS; f++) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            uint64_t value = seed >> (seed % 64);
+            len += snprintf(lines[i] + len, MAX_LINE_LEN - (size_t)len, " %8llu",
+                            (unsigned long long)value);
+        }
+        snprintf(lines[i] + len, MAX_LINE_LEN - (size_t)len, "\n");
+    }
+}
+
+/**
+ * Time fn over every line; with match set, each line is parsed for its own
+ * interface, otherwise for a name that never matches
+ * Returns nanoseconds per line
+ */
+static double run(parse_fn fn, char (*lines)[MAX_LINE_LEN], char (*names)[MAX_IFACE_LEN],
+                  size_t count, bool match, uint64_t *checksum) {
+    net_stats_t stats = {0};
+    uint64_t sum = 0;
+
+    double start = now_seconds();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (size_t i = 0; i < count; i++) {
+            if (fn(lines[i], match ? names[i] : "nomatch0", &stats)) {
+                sum += stats.rx_bytes ^ stats.tx_drops;
+            }
+        }
+    }
+    double elapsed = now_seconds() - start;
+
+    *checksum = sum;
+    return elapsed * 1e9 / ((double)count * BENCH_ROUNDS);
+}
+
+static bool same_stats(const net_stats_t *a, const net_stats_t *b) {
+    return strcmp(a->interface, b->interface) == 0 && a->valid == b->valid &&
+           a->rx_bytes == b->rx_bytes && a->rx_packets == b->rx_packets &&
+           a->rx_errors == b->rx_errors && a->rx_drops == b->rx_drops &&
+           a->tx_bytes == b->tx_bytes && a->tx_packets == b->tx_packets &&
+           a->tx_errors == b->tx_errors && a->tx_drops == b->tx_drops;
+}
+
+static bool verify(char (*lines)[MAX_LINE_LEN], char (*names)[MAX_IFACE_LEN], size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        net_stats_t a = {0}, b = {0};
+        bool ok_a = legacy_parse_interface_line(lines[i], names[i], &a);
+        bool ok_b = parse_interface_line(lines[i], names[i], &b);
+        if (ok_a != ok_b || !same_stats(&a, &b)) {
+            fprintf(stderr, "Mismatch on line %zu: %s", i, lines[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(void) {
+    static char lines[BENCH_LINES][MAX_LINE_LEN];
+    static char names[BENCH_LINES][MAX_IFACE_LEN];
+
+    build_lines(lines, names, BENCH_LINES);
+    if (!verify(lines, names, BENCH_LINES)) {
+        return EXIT_FAILURE;
+    }
+
+    printf("parse_interface_line: %d lines x %d rounds\n", BENCH_LINES, BENCH_ROUNDS);
+    printf("%-10s %14s %14s %10s\n", "Case", "strtok (ns)", "single (ns)", "Speedup");
+
+    for (int match = 1; match >= 0; match--) {
+        uint64_t sum_legacy, sum_single;
+        double legacy = run(legacy_parse_interface_line, lines, names, BENCH_LINES,
+                            match, &sum_legacy);
+        double single = run(parse_interface_line, lines, names, BENCH_LINES,
+                            match, &sum_single);
+        if (sum_legacy != sum_single) {
+            fprintf(stderr, "Checksum mismatch\n");
+            return EXIT_FAILURE;
+        }
+        printf("%-10s %14.1f %14.1f %9.1fx\n", match ? "match" : "skip",
+               legacy, single, legacy / single);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "netstat_monitor.h"
+#include "iface_soa.h"
+#include "rate.h"
+
+#define BENCH_IFACES 100000
+#define BENCH_ROUNDS 50
+
+static const char *kernel_names[] = {"scalar", "avx2"};
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t next_random(uint64_t *seed) {
+    *seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return *seed >> (*seed % 64);
+}
+
+/**
+ * One tick of BENCH_IFACES interfaces: counters of every magnitude, some
+ * wrapped at 32 bits, a few slots missing from the sample or without a
+ * baseline, and elapsed times that differ per slot
+ */
+static bool build_table(iface_soa_t *soa, net_stats_t *cur, net_stats_t *prev) {
+    uint64_t seed = 42;
+    char name[MAX_IFACE_LEN];
+
+    for (size_t i = 0; i < BENCH_IFACES; i++) {
+        int len = snprintf(name, sizeof(name), "veth%zu", i);
+        if (!iface_soa_add(soa, name, (size_t)len)) {
+            return false;
+        }
+        int64_t then = (int64_t)NSEC_PER_SEC + (int64_t)(next_random(&seed) % 1000000);
+        int64_t now = then + 1000000 + (int64_t)(next_random(&seed) % 2000000000);
+        uint64_t before[IFACE_COUNTERS], after[IFACE_COUNTERS];
+        for (int c = 0; c < IFACE_COUNTERS; c++) {
+            before[c] = next_random(&seed);
+            after[c] = before[c] + next_random(&seed) % 100000000;
+            if (next_random(&seed) % 16 == 0) {
+                /* A 32-bit counter that wrapped */
+                before[c] = 0xffff0000u + next_random(&seed) % 0x10000;
+                after[c] = next_random(&seed) % 0x100000;
+            }
+            soa->previous[c][i] = before[c];
+            soa->current[c][i] = after[c];
+        }
+        soa->previous_ns[i] = then;
+        soa->time_ns[i] = now;
+        soa->seen[i] = next_random(&seed) % 64 != 0;
+        soa->has_previous[i] = next_random(&seed) % 64 != 0;
+
+        iface_soa_get(soa, i, &cur[i], &prev[i]);
+    }
+    return true;
+}
+
+/**
+ * What the row renderers do per interface: one timespec_diff(), then
+ * safe_delta() and calculate_rate() for every counter
+ */
+static void legacy_pass(const net_stats_t *cur, const net_stats_t *prev, uint64_t *delta,
+                        double *rate) {
+    for (size_t i = 0; i < BENCH_IFACES; i++) {
+        const uint64_t *c = &cur[i].rx_bytes;
+        const uint64_t *p = &prev[i].rx_bytes;
+        double elapsed = 0.0;
+        if (cur[i].valid && prev[i].valid) {
+            elapsed = timespec_diff(&prev[i].timestamp, &cur[i].timestamp);
+        }
+        for (int k = 0; k < IFACE_COUNTERS; k++) {
+            uint64_t d = safe_delta(c[k], p[k]);
+            delta[i * IFACE_COUNTERS + k] = d;
+            rate[i * IFACE_COUNTERS + k] = calculate_rate(d, elapsed);
+        }
+    }
+}
+
+/**
+ * Check a kernel's columns: deltas exactly equal to safe_delta(), rates
+ * within rounding of a division by elapsed, and bit-identical across
+ * kernels. Returns false on a mismatch
+ */
+static bool verify(const iface_soa_t *soa, const uint64_t *delta, const double *rate,
+                   double **first) {
+    for (int c = 0; c < IFACE_COUNTERS; c++) {
+        for (size_t i = 0; i < BENCH_IFACES; i++) {
+            uint64_t want_delta = delta[i * IFACE_COUNTERS + c];
+            double want_rate = rate[i * IFACE_COUNTERS + c];
+            double got = soa->rate[c][i];
+            if (soa->delta[c][i] != want_delta ||
+                fabs(got - want_rate) > fabs(want_rate) * 1e-15 ||
+                (first[c] && memcmp(&first[c][i], &got, sizeof(got)) != 0)) {
+                fprintf(stderr, "%s: mismatch on interface %zu, counter %d\n",
+                        soa->kernel->name, i, c);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(void) {
+    iface_soa_t soa = {0};
+    net_stats_t *cur = calloc(BENCH_IFACES, sizeof(*cur));
+    net_stats_t *prev = calloc(BENCH_IFACES, sizeof(*prev));
+    uint64_t *delta = calloc(BENCH_IFACES * IFACE_COUNTERS, sizeof(*delta));
+    double *rate = calloc(BENCH_IFACES * IFACE_COUNTERS, sizeof(*rate));
+    double *first[IFACE_COUNTERS] = {0};
+    bool ok = cur && prev && delta && rate;
+    if (!ok || !build_table(&soa, cur, prev)) {
+        fprintf(stderr, "Out of memory\n");
+        ok = false;
+        goto out;
+    }
+
+    printf("%d interface-samples per tick, %d rounds\n", BENCH_IFACES, BENCH_ROUNDS);
+    printf("%-8s %14s %16s\n", "Kernel", "us per tick", "Msamples/s");
+
+    legacy_pass(cur, prev, delta, rate);
+    double start = now_seconds();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        legacy_pass(cur, prev, delta, rate);
+    }
+    double elapsed = (now_seconds() - start) / BENCH_ROUNDS;
+    printf("%-8s %14.1f %16.1f\n", "per-row", elapsed * 1e6, BENCH_IFACES / elapsed / 1e6);
+
+    for (size_t k = 0; k < sizeof(kernel_names) / sizeof(kernel_names[0]); k++) {
+        soa.kernel = iface_soa_kernel_get(kernel_names[k]);
+        if (!soa.kernel) {
+            printf("%-8s %14s %16s\n", kernel_names[k], "unsupported", "unsupported");
+            continue;
+        }
+
+        iface_soa_compute(&soa);
+        if (!verify(&soa, delta, rate, first)) {
+            ok = false;
+            goto out;
+        }
+        /* Swap out the first kernel's rates as the reference for the others */
+        if (!first[0]) {
+            for (int c = 0; c < IFACE_COUNTERS; c++) {
+                first[c] = soa.rate[c];
+                soa.rate[c] = malloc(soa.capacity * sizeof(double));
+                if (!soa.rate[c]) {
+                    fprintf(stderr, "Out of memory\n");
+                    ok = false;
+                    goto out;
+                }
+            }
+        }
+
+        start = now_seconds();
+        for (int round = 0; round < BENCH_ROUNDS; round++) {
+            iface_soa_compute(&soa);
+        }
+        elapsed = (now_seconds() - start) / BENCH_ROUNDS;
+        printf("%-8s %14.1f %16.1f\n", soa.kernel->name, elapsed * 1e6,
+               BENCH_IFACES / elapsed / 1e6);
+    }
+
+out:
+    for (int c = 0; c < IFACE_COUNTERS; c++) {
+        free(first[c]);
+    }
+    iface_soa_free(&soa);
+    free(cur);
+    free(prev);
+    free(delta);
+    free(rate);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
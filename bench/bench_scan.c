@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "netstat_monitor.h"
+#include "procfs.h"
+
+#define BENCH_IFACES 5000
+#define BENCH_ROUNDS 50
+
+static const char *scanner_names[] = {"scalar", "sse2", "avx2"};
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t next_random(uint64_t *seed) {
+    *seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return *seed >> (*seed % 64);
+}
+
+/**
+ * Counter for field f: with wide set, of any length from 1 to 20 digits;
+ * otherwise shaped like a busy container host, where byte and packet
+ * counters are large and the error, drop and fifo columns mostly zero
+ */
+static uint64_t counter_value(uint64_t *seed, int f, bool wide) {
+    uint64_t r = next_random(seed);
+    if (wide) {
+        return r;
+    }
+    switch (f) {
+    case 0: case 8:
+        return r & ((UINT64_C(1) << 40) - 1);
+    case 1: case 9:
+        return r & ((UINT64_C(1) << 30) - 1);
+    default:
+        return (r & 7) == 0 ? r & 0xFFF : 0;
+    }
+}
+
+/**
+ * Build a /proc/net/dev image for count veth interfaces using the kernel's
+ * own column widths
+ */
+static char *build_proc_net_dev(size_t count, bool wide, size_t *len) {
+    size_t cap = 256 + count * 256;
+    char *buf = malloc(cap);
+    if (!buf) {
+        return NULL;
+    }
+
+    size_t n = (size_t)snprintf(buf, cap,
+        "Inter-|   Receive                                                |  Transmit\n"
+        " face |bytes    packets errs drop fifo frame compressed multicast|"
+        "bytes    packets errs drop fifo colls carrier compressed\n");
+
+    uint64_t seed = 0x9e3779b97f4a7c15ULL;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t v[PROC_NET_DEV_FIELDS];
+        for (int f = 0; f < PROC_NET_DEV_FIELDS; f++) {
+            v[f] = counter_value(&seed, f, wide);
+        }
+        n += (size_t)snprintf(buf + n, cap - n,
+            "%6s%05zu:%8llu %7llu %4llu %4llu %4llu %5llu %10llu %9llu "
+            "%8llu %7llu %4llu %4llu %4llu %5llu %7llu %10llu\n",
+            "veth", i,
+            (unsigned long long)v[0], (unsigned long long)v[1], (unsigned long long)v[2],
+            (unsigned long long)v[3], (unsigned long long)v[4], (unsigned long long)v[5],
+            (unsigned long long)v[6], (unsigned long long)v[7], (unsigned long long)v[8],
+            (unsigned long long)v[9], (unsigned long long)v[10], (unsigned long long)v[11],
+            (unsigned long long)v[12], (unsigned long long)v[13], (unsigned long long)v[14],
+            (unsigned long long)v[15]);
+    }
+
+    *len = n;
+    return buf;
+}
+
+/**
+ * One pass over buf with the given scanner; with parse set every line is
+ * converted into stats[], otherwise lines are only split and named
+ * Returns the number of data lines handled
+ */
+static size_t scan_pass(const procfs_scanner_t *scanner, const char *buf,
+                        net_stats_t *stats, bool parse) {
+    const char *line = buf;
+    for (int i = 0; i < 2; i++) {
+        line = scanner->line_end(line) + 1;
+    }
+
+    size_t idx = 0;
+    while (*line) {
+        size_t name_len;
+        const char *fields;
+        const char *eol = NULL;
+        if (scanner->line_name(line, &name_len, &fields) && parse) {
+            eol = scanner->parse_counters(fields, &stats[idx]);
+        }
+        if (!eol) {
+            eol = scanner->line_end(line);
+        }
+        idx++;
+        line = *eol ? eol + 1 : eol;
+    }
+    return idx;
+}
+
+static bool same_counters(const net_stats_t *a, const net_stats_t *b) {
+    return a->valid == b->valid &&
+           a->rx_bytes == b->rx_bytes && a->rx_packets == b->rx_packets &&
+           a->rx_errors == b->rx_errors && a->rx_drops == b->rx_drops &&
+           a->tx_bytes == b->tx_bytes && a->tx_packets == b->tx_packets &&
+           a->tx_errors == b->tx_errors && a->tx_drops == b->tx_drops;
+}
+
+/**
+ * Check every scanner against the scalar one on buf, then report parse and
+ * skip throughput. Returns false on a mismatch
+ */
+static bool run_dataset(const char *label, bool wide) {
+    size_t len;
+    char *buf = build_proc_net_dev(BENCH_IFACES, wide, &len);
+    net_stats_t *reference = calloc(BENCH_IFACES, sizeof(*reference));
+    net_stats_t *stats = calloc(BENCH_IFACES, sizeof(*stats));
+    bool ok = buf && reference && stats;
+    if (!ok) {
+        fprintf(stderr, "Out of memory\n");
+        goto out;
+    }
+
+    scan_pass(&procfs_scanner_scalar, buf, reference, true);
+
+    printf("%s: %d interfaces, %.1f KB, %d rounds\n",
+           label, BENCH_IFACES, (double)len / 1024.0, BENCH_ROUNDS);
+    printf("%-8s %14s %14s\n", "Scanner", "parse (MB/s)", "skip (MB/s)");
+
+    for (size_t s = 0; s < sizeof(scanner_names) / sizeof(scanner_names[0]); s++) {
+        const procfs_scanner_t *scanner = procfs_scanner_get(scanner_names[s]);
+        if (!scanner) {
+            printf("%-8s %14s %14s\n", scanner_names[s], "unsupported", "unsupported");
+            continue;
+        }
+
+        memset(stats, 0, BENCH_IFACES * sizeof(*stats));
+        scan_pass(scanner, buf, stats, true);
+        for (size_t i = 0; i < BENCH_IFACES; i++) {
+            if (!same_counters(&stats[i], &reference[i])) {
+                fprintf(stderr, "%s: mismatch on interface %zu\n", scanner->name, i);
+                ok = false;
+                goto out;
+            }
+        }
+
+        double mb[2];
+        for (int parse = 1; parse >= 0; parse--) {
+            double start = now_seconds();
+            for (int round = 0; round < BENCH_ROUNDS; round++) {
+                scan_pass(scanner, buf, stats, parse);
+            }
+            double elapsed = now_seconds() - start;
+            mb[parse] = (double)len * BENCH_ROUNDS / elapsed / (1024.0 * 1024.0);
+        }
+        printf("%-8s %14.1f %14.1f\n", scanner->name, mb[1], mb[0]);
+    }
+    printf("\n");
+
+out:
+    free(stats);
+    free(reference);
+    free(buf);
+    return ok;
+}
+
+int main(void) {
+    bool ok = run_dataset("typical counters", false);
+    ok = run_dataset("1-20 digit counters", true) && ok;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
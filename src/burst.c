@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <string.h>
+
+#include "burst.h"
+
+void burst_reset(burst_stats_t *burst) {
+    memset(burst, 0, sizeof(*burst));
+}
+
+static inline void range_add(burst_range_t *range, double rate, uint32_t count) {
+    if (count == 0 || rate < range->min) {
+        range->min = rate;
+    }
+    if (count == 0 || rate > range->max) {
+        range->max = rate;
+    }
+    range->sum += rate;
+}
+
+/**
+ * Fold the rates between two consecutive sub-samples into the interval
+ */
+void burst_add(burst_stats_t *burst, double rx_bytes, double tx_bytes, double rx_packets,
+               double tx_packets) {
+    uint32_t n = burst->count;
+
+    range_add(&burst->rx_bytes, rx_bytes, n);
+    range_add(&burst->tx_bytes, tx_bytes, n);
+    range_add(&burst->rx_packets, rx_packets, n);
+    range_add(&burst->tx_packets, tx_packets, n);
+    burst->count = n + 1;
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef BURST_H
+#define BURST_H
+
+#include <stdint.h>
+
+typedef struct {
+    double min;
+    double max;
+    double sum;
+} burst_range_t;
+
+/*
+ * Rates over the fine sub-intervals of one reporting interval, kept as
+ * running min/max/sum so that folding in a sub-sample never allocates
+ */
+typedef struct {
+    burst_range_t rx_bytes;
+    burst_range_t tx_bytes;
+    burst_range_t rx_packets;
+    burst_range_t tx_packets;
+    uint32_t count;
+} burst_stats_t;
+
+void burst_reset(burst_stats_t *burst);
+void burst_add(burst_stats_t *burst, double rx_bytes, double tx_bytes, double rx_packets,
+               double tx_packets);
+
+static inline double burst_mean(const burst_range_t *range, uint32_t count) {
+    return count ? range->sum / count : 0.0;
+}
+
+#endif /* BURST_H */
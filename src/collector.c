@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include "collector.h"
+
+/* ---- Backend adapters ---- */
+
+static bool procfs_init(collector_t *collector, const iface_table_t *table) {
+    (void)table;
+    procfs_reader_t *reader = &collector->backend.procfs;
+    if (!procfs_open(reader, collector->options.reopen)) {
+        return false;
+    }
+    if (collector->options.scanner) {
+        reader->scanner = collector->options.scanner;
+    }
+    collector->io = &reader->io;
+    return true;
+}
+
+static bool procfs_sample(collector_t *collector, iface_table_t *table) {
+    return read_net_stats(&collector->backend.procfs, table);
+}
+
+static void procfs_fini(collector_t *collector) {
+    procfs_close(&collector->backend.procfs);
+}
+
+static bool netlink_init(collector_t *collector, const iface_table_t *table) {
+    (void)table;
+    if (!netlink_open(&collector->backend.netlink)) {
+        return false;
+    }
+    collector->io = &collector->backend.netlink.io;
+    return true;
+}
+
+static bool netlink_sample(collector_t *collector, iface_table_t *table) {
+    return netlink_read_stats(&collector->backend.netlink, table);
+}
+
+static void netlink_fini(collector_t *collector) {
+    netlink_close(&collector->backend.netlink);
+}
+
+static bool sysfs_init(collector_t *collector, const iface_table_t *table) {
+    if (table->watch_all) {
+        fprintf(stderr, "Error: The sysfs source needs explicit interface names\n");
+        return false;
+    }
+    if (!sysfs_open(&collector->backend.sysfs, table)) {
+        return false;
+    }
+    collector->io = &collector->backend.sysfs.io;
+    return true;
+}
+
+static bool sysfs_sample(collector_t *collector, iface_table_t *table) {
+    return sysfs_read_stats(&collector->backend.sysfs, table);
+}
+
+static void sysfs_fini(collector_t *collector) {
+    sysfs_close(&collector->backend.sysfs);
+}
+
+static bool replay_init(collector_t *collector, const iface_table_t *table) {
+    (void)table;
+    const procfs_scanner_t *scanner = collector->options.scanner;
+    if (!replay_open(&collector->backend.replay, collector->options.replay_path,
+                     scanner ? scanner : procfs_scanner_get(NULL))) {
+        return false;
+    }
+    collector->io = &collector->backend.replay.io;
+    return true;
+}
+
+static bool replay_sample(collector_t *collector, iface_table_t *table) {
+    return replay_read_stats(&collector->backend.replay, table, &collector->exhausted);
+}
+
+static void replay_fini(collector_t *collector) {
+    replay_close(&collector->backend.replay);
+}
+
+static const collector_ops_t collector_backends[] = {
+    [SOURCE_PROCFS] = {"procfs", procfs_init, procfs_sample, procfs_fini},
+    [SOURCE_NETLINK] = {"netlink", netlink_init, netlink_sample, netlink_fini},
+    [SOURCE_SYSFS] = {"sysfs", sysfs_init, sysfs_sample, sysfs_fini},
+    [SOURCE_REPLAY] = {"replay", replay_init, replay_sample, replay_fini},
+};
+
+/* ---- Source selection ---- */
+
+bool collector_parse_source(const char *name, stats_source_t *source) {
+    if (strcmp(name, "auto") == 0) {
+        *source = SOURCE_AUTO;
+        return true;
+    }
+    for (size_t i = 0; i < sizeof(collector_backends) / sizeof(collector_backends[0]); i++) {
+        if (collector_backends[i].name && strcmp(name, collector_backends[i].name) == 0) {
+            *source = (stats_source_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Resolve --source auto: per-counter sysfs reads win when only a few of
+ * the system's interfaces are watched, a full /proc/net/dev scan otherwise
+ */
+stats_source_t collector_pick_source(const iface_table_t *table) {
+    if (table->watch_all) {
+        return SOURCE_PROCFS;
+    }
+    size_t total = sysfs_count_interfaces();
+    if (total > 0 && table->count * SYSFS_AUTO_RATIO <= total) {
+        return SOURCE_SYSFS;
+    }
+    return SOURCE_PROCFS;
+}
+
+/* ---- Lifecycle and instrumentation ---- */
+
+bool collector_init(collector_t *collector, stats_source_t source,
+                    const collector_options_t *options, const iface_table_t *table) {
+    memset(collector, 0, sizeof(*collector));
+    collector->options = *options;
+
+    if (source == SOURCE_AUTO) {
+        source = collector_pick_source(table);
+    }
+    const collector_ops_t *ops = &collector_backends[source];
+    if (!ops->init(collector, table)) {
+        return false;
+    }
+
+    collector->ops = ops;
+    collector->io_baseline = *collector->io;
+    return true;
+}
+
+void collector_close(collector_t *collector) {
+    if (collector->ops) {
+        collector->ops->close(collector);
+        collector->ops = NULL;
+    }
+}
+
+static uint64_t elapsed_ns(const struct timespec *start, const struct timespec *end) {
+    return (uint64_t)(end->tv_sec - start->tv_sec) * NSEC_PER_SEC +
+           (uint64_t)end->tv_nsec - (uint64_t)start->tv_nsec;
+}
+
+/**
+ * Collect one sample from the backend and record its latency
+ * On failure, exhausted tells a finished replay apart from an error
+ */
+bool collector_sample(collector_t *collector, iface_table_t *table) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    bool ok = collector->ops->sample(collector, table);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (ok) {
+        latency_record(&collector->latency, elapsed_ns(&start, &end));
+    } else if (!collector->exhausted) {
+        collector->failures++;
+    }
+    return ok;
+}
+
+void collector_print_summary(const collector_t *collector, FILE *out) {
+    const latency_stats_t *latency = &collector->latency;
+    if (!collector->ops || latency->samples == 0) {
+        return;
+    }
+
+    double samples = (double)latency->samples;
+    uint64_t syscalls = collector->io->syscalls - collector->io_baseline.syscalls;
+    uint64_t bytes = collector->io->bytes - collector->io_baseline.bytes;
+
+    fprintf(out, "Collection (%s): %llu samples, %llu failed\n", collector->ops->name,
+            (unsigned long long)latency->samples, (unsigned long long)collector->failures);
+    fprintf(out, "  latency: min %.1f us, avg %.1f us, p99 %.1f us, max %.1f us\n",
+            (double)latency->min_ns / 1e3, (double)latency->total_ns / samples / 1e3,
+            (double)latency_percentile(latency, 99.0) / 1e3,
+            (double)latency->max_ns / 1e3);
+    fprintf(out, "  per sample: %.1f syscalls, %.0f bytes read\n",
+            (double)syscalls / samples, (double)bytes / samples);
+}
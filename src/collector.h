@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef COLLECTOR_H
+#define COLLECTOR_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "netstat_monitor.h"
+#include "iface_table.h"
+#include "procfs.h"
+#include "netlink.h"
+#include "sysfs.h"
+#include "replay.h"
+#include "latency.h"
+
+typedef enum {
+    SOURCE_AUTO,
+    SOURCE_PROCFS,
+    SOURCE_NETLINK,
+    SOURCE_SYSFS,
+    SOURCE_REPLAY,
+} stats_source_t;
+
+typedef struct {
+    bool reopen;
+    const procfs_scanner_t *scanner;
+    const char *replay_path;
+} collector_options_t;
+
+typedef struct collector collector_t;
+
+/*
+ * A statistics backend. init opens whatever the backend keeps across
+ * samples, sample fills every watched slot of the table and stamps it,
+ * close releases everything init acquired
+ */
+typedef struct {
+    const char *name;
+    bool (*init)(collector_t *collector, const iface_table_t *table);
+    bool (*sample)(collector_t *collector, iface_table_t *table);
+    void (*close)(collector_t *collector);
+} collector_ops_t;
+
+struct collector {
+    const collector_ops_t *ops;
+    collector_options_t options;
+    union {
+        procfs_reader_t procfs;
+        netlink_reader_t netlink;
+        sysfs_reader_t sysfs;
+        replay_reader_t replay;
+    } backend;
+    const io_counters_t *io;
+    io_counters_t io_baseline;
+    latency_stats_t latency;
+    uint64_t failures;
+    bool exhausted;
+};
+
+bool collector_parse_source(const char *name, stats_source_t *source);
+stats_source_t collector_pick_source(const iface_table_t *table);
+bool collector_init(collector_t *collector, stats_source_t source,
+                    const collector_options_t *options, const iface_table_t *table);
+bool collector_sample(collector_t *collector, iface_table_t *table);
+void collector_close(collector_t *collector);
+void collector_print_summary(const collector_t *collector, FILE *out);
+
+#endif /* COLLECTOR_H */
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+
+#include "event_loop.h"
+
+/* Events handled per epoll_wait() */
+#define EVENT_BATCH 64
+
+/* SIGINT and SIGTERM arrive as readable data rather than interruptions */
+static void on_signal(event_source_t *source, uint32_t events) {
+    event_loop_t *loop = source->ctx;
+    struct signalfd_siginfo info;
+    (void)events;
+
+    while (read(source->fd, &info, sizeof(info)) == (ssize_t)sizeof(info)) {
+        loop->stopped = true;
+    }
+}
+
+/**
+ * Create the epoll instance and route SIGINT and SIGTERM through a
+ * signalfd; the signals stay blocked until event_loop_close(), also in
+ * threads started in between
+ */
+bool event_loop_init(event_loop_t *loop) {
+    sigset_t mask;
+
+    memset(loop, 0, sizeof(*loop));
+    loop->signals.fd = -1;
+    loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (loop->epoll_fd < 0) {
+        fprintf(stderr, "Error: Cannot create epoll instance: %s\n", strerror(errno));
+        return false;
+    }
+
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    int rc = pthread_sigmask(SIG_BLOCK, &mask, &loop->old_mask);
+    if (rc != 0) {
+        fprintf(stderr, "Error: Cannot block signals: %s\n", strerror(rc));
+        event_loop_close(loop);
+        return false;
+    }
+    loop->signals.fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    loop->signals.callback = on_signal;
+    loop->signals.ctx = loop;
+    if (loop->signals.fd < 0) {
+        fprintf(stderr, "Error: Cannot create signalfd: %s\n", strerror(errno));
+        pthread_sigmask(SIG_SETMASK, &loop->old_mask, NULL);
+        event_loop_close(loop);
+        return false;
+    }
+    if (!event_loop_add(loop, &loop->signals, EPOLLIN)) {
+        event_loop_close(loop);
+        return false;
+    }
+    return true;
+}
+
+bool event_loop_add(event_loop_t *loop, event_source_t *source, uint32_t events) {
+    struct epoll_event ev = {.events = events, .data.ptr = source};
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, source->fd, &ev) != 0) {
+        fprintf(stderr, "Error: Cannot watch descriptor %d: %s\n", source->fd, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool event_loop_modify(event_loop_t *loop, event_source_t *source, uint32_t events) {
+    struct epoll_event ev = {.events = events, .data.ptr = source};
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_MOD, source->fd, &ev) != 0) {
+        fprintf(stderr, "Error: Cannot watch descriptor %d: %s\n", source->fd, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+/* Must be called before the source's descriptor is closed */
+void event_loop_remove(event_loop_t *loop, event_source_t *source) {
+    if (loop->epoll_fd < 0) {
+        return;
+    }
+    epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, source->fd, NULL);
+}
+
+/**
+ * Block until at least one source is ready and run the callbacks of
+ * everything that is. A callback may remove and free its own source but
+ * no other. Returns false once a shutdown signal has arrived
+ */
+bool event_loop_wait(event_loop_t *loop) {
+    struct epoll_event events[EVENT_BATCH];
+
+    if (loop->stopped) {
+        return false;
+    }
+    int n = epoll_wait(loop->epoll_fd, events, EVENT_BATCH, -1);
+    if (n < 0) {
+        if (errno == EINTR) {
+            return true;
+        }
+        fprintf(stderr, "Error: epoll_wait failed: %s\n", strerror(errno));
+        loop->stopped = true;
+        return false;
+    }
+    for (int i = 0; i < n; i++) {
+        event_source_t *source = events[i].data.ptr;
+        source->callback(source, events[i].events);
+    }
+    return !loop->stopped;
+}
+
+void event_loop_close(event_loop_t *loop) {
+    if (loop->signals.fd >= 0) {
+        close(loop->signals.fd);
+        loop->signals.fd = -1;
+        pthread_sigmask(SIG_SETMASK, &loop->old_mask, NULL);
+    }
+    if (loop->epoll_fd >= 0) {
+        close(loop->epoll_fd);
+        loop->epoll_fd = -1;
+    }
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+
+/*
+ * Single-threaded epoll loop. Everything that waits — the sampling timer,
+ * shutdown signals, exporter sockets, a backed-up output pipe — registers
+ * an event source and gets a callback when its descriptor is ready
+ */
+typedef struct event_source {
+    int fd;
+    void (*callback)(struct event_source *source, uint32_t events);
+    void *ctx;
+} event_source_t;
+
+typedef struct {
+    int epoll_fd;
+    event_source_t signals;
+    sigset_t old_mask;
+    bool stopped;
+} event_loop_t;
+
+bool event_loop_init(event_loop_t *loop);
+bool event_loop_add(event_loop_t *loop, event_source_t *source, uint32_t events);
+bool event_loop_modify(event_loop_t *loop, event_source_t *source, uint32_t events);
+void event_loop_remove(event_loop_t *loop, event_source_t *source);
+bool event_loop_wait(event_loop_t *loop);
+void event_loop_close(event_loop_t *loop);
+
+#endif /* EVENT_LOOP_H */
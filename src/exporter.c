@@ -0,0 +1,446 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+
+#include "exporter.h"
+
+static const char not_found[] =
+    "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain; charset=utf-8\r\n"
+    "Content-Length: 10\r\nConnection: close\r\n\r\nNot Found\n";
+static const char unavailable[] =
+    "HTTP/1.1 503 Service Unavailable\r\nContent-Type: text/plain; charset=utf-8\r\n"
+    "Content-Length: 13\r\nConnection: close\r\n\r\nNo sample yet\n";
+
+typedef struct {
+    const char *name;
+    const char *help;
+    int column;
+} metric_t;
+
+static const metric_t metrics[] = {
+    {"netstat_monitor_receive_bytes_total", "Bytes received.",
+     IFACE_RX_BYTES},
+    {"netstat_monitor_receive_packets_total", "Packets received.",
+     IFACE_RX_PACKETS},
+    {"netstat_monitor_receive_errors_total", "Receive errors.",
+     IFACE_RX_ERRORS},
+    {"netstat_monitor_receive_drop_total", "Received packets dropped.",
+     IFACE_RX_DROPS},
+    {"netstat_monitor_transmit_bytes_total", "Bytes transmitted.",
+     IFACE_TX_BYTES},
+    {"netstat_monitor_transmit_packets_total", "Packets transmitted.",
+     IFACE_TX_PACKETS},
+    {"netstat_monitor_transmit_errors_total", "Transmit errors.",
+     IFACE_TX_ERRORS},
+    {"netstat_monitor_transmit_drop_total", "Transmitted packets dropped.",
+     IFACE_TX_DROPS},
+};
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static bool set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static void on_listen(event_source_t *source, uint32_t events);
+
+/**
+ * Listen on [host:]port, [v6-host]:port or host:port; a bare port binds
+ * to the loopback address only
+ */
+bool exporter_open(exporter_t *exporter, const char *address, event_loop_t *loop) {
+    char host[256];
+    const char *port = strrchr(address, ':');
+
+    memset(exporter, 0, sizeof(*exporter));
+    exporter->listener.fd = -1;
+    exporter->listener.callback = on_listen;
+    exporter->listener.ctx = exporter;
+    exporter->loop = loop;
+
+    if (!port) {
+        snprintf(host, sizeof(host), "%s", EXPORTER_DEFAULT_HOST);
+        port = address;
+    } else {
+        size_t len = (size_t)(port - address);
+        if (len >= 2 && address[0] == '[' && address[len - 1] == ']') {
+            address++;
+            len -= 2;
+        }
+        if (len == 0 || len >= sizeof(host)) {
+            fprintf(stderr, "Error: Invalid metrics address: %s\n", address);
+            return false;
+        }
+        memcpy(host, address, len);
+        host[len] = '\0';
+        port++;
+    }
+
+    struct addrinfo hints = {0};
+    struct addrinfo *result = NULL;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+    int rc = getaddrinfo(host, port, &hints, &result);
+    if (rc != 0) {
+        fprintf(stderr, "Error: Invalid metrics address %s:%s: %s\n", host, port, gai_strerror(rc));
+        return false;
+    }
+
+    int fd = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+    int one = 1;
+    if (fd < 0 || setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0 ||
+        bind(fd, result->ai_addr, result->ai_addrlen) != 0 || listen(fd, SOMAXCONN) != 0 ||
+        !set_nonblocking(fd) || fcntl(fd, F_SETFD, FD_CLOEXEC) != 0) {
+        fprintf(stderr, "Error: Cannot listen on %s:%s: %s\n", host, port, strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+        }
+        freeaddrinfo(result);
+        return false;
+    }
+    freeaddrinfo(result);
+
+    exporter->listener.fd = fd;
+    if (!event_loop_add(loop, &exporter->listener, EPOLLIN)) {
+        exporter_close(exporter);
+        return false;
+    }
+    return true;
+}
+
+/* Exposition rendering */
+
+static bool body_reserve(exporter_body_t *body, size_t extra) {
+    if (body->len + extra <= body->capacity) {
+        return true;
+    }
+    size_t capacity = body->capacity ? body->capacity : 16384;
+    while (capacity < body->len + extra) {
+        capacity *= 2;
+    }
+    char *data = realloc(body->data, capacity);
+    if (!data) {
+        return false;
+    }
+    body->data = data;
+    body->capacity = capacity;
+    return true;
+}
+
+static inline char *put_u64(char *p, uint64_t value) {
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (n) {
+        *p++ = digits[--n];
+    }
+    return p;
+}
+
+/* Label values escape backslash, double quote and newline */
+static inline char *put_label(char *p, const char *value) {
+    for (; *value; value++) {
+        if (*value == '\\' || *value == '"') {
+            *p++ = '\\';
+            *p++ = *value;
+        } else if (*value == '\n') {
+            *p++ = '\\';
+            *p++ = 'n';
+        } else {
+            *p++ = *value;
+        }
+    }
+    return p;
+}
+
+static bool render(exporter_body_t *body, const iface_soa_t *table, const struct timespec *wall) {
+    /* Worst case per sample: name, fully escaped label, counter */
+    const size_t sample_max = 64 + 2 * MAX_IFACE_LEN + 32;
+    const size_t family_max = 256;
+
+    body->len = EXPORTER_HEADER_RESERVE;
+    for (size_t m = 0; m < sizeof(metrics) / sizeof(metrics[0]); m++) {
+        const metric_t *metric = &metrics[m];
+        if (!body_reserve(body, family_max + table->count * sample_max)) {
+            return false;
+        }
+        char *p = body->data + body->len;
+        p += sprintf(p, "# HELP %s %s\n# TYPE %s counter\n",
+                     metric->name, metric->help, metric->name);
+        size_t name_len = strlen(metric->name);
+        const uint64_t *values = table->current[metric->column];
+        for (size_t i = 0; i < table->count; i++) {
+            if (!table->seen[i]) {
+                continue;
+            }
+            memcpy(p, metric->name, name_len);
+            p += name_len;
+            memcpy(p, "{interface=\"", 12);
+            p = put_label(p + 12, iface_soa_name(table, i));
+            memcpy(p, "\"} ", 3);
+            p = put_u64(p + 3, values[i]);
+            *p++ = '\n';
+        }
+        body->len = (size_t)(p - body->data);
+    }
+
+    if (!body_reserve(body, family_max)) {
+        return false;
+    }
+    body->len += (size_t)sprintf(body->data + body->len,
+                                 "# HELP netstat_monitor_last_sample_seconds Wall-clock time of the sample.\n"
+                                 "# TYPE netstat_monitor_last_sample_seconds gauge\n"
+                                 "netstat_monitor_last_sample_seconds %lld.%03ld\n",
+                                 (long long)wall->tv_sec, wall->tv_nsec / 1000000);
+
+    /* Headers end exactly where the body starts */
+    char header[EXPORTER_HEADER_RESERVE];
+    size_t content = body->len - EXPORTER_HEADER_RESERVE;
+    int header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.1 200 OK\r\n"
+                              "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                              "Content-Length: %zu\r\nConnection: close\r\n\r\n", content);
+    body->start = EXPORTER_HEADER_RESERVE - (size_t)header_len;
+    memcpy(body->data + body->start, header, (size_t)header_len);
+    return true;
+}
+
+static void client_close(exporter_t *exporter, exporter_client_t *client);
+
+/**
+ * Render the exposition for this tick into the back buffer and make it
+ * the one new scrapes get. If a slow client is still sending the back
+ * buffer, it is left alone and scrapes keep getting the previous tick
+ * Connections that outlived EXPORTER_TIMEOUT_NS are dropped here too
+ */
+void exporter_publish(exporter_t *exporter, const iface_soa_t *table,
+                      const struct timespec *wall) {
+    uint64_t now = monotonic_ns();
+    for (size_t i = exporter->count; i-- > 0;) {
+        if (exporter->clients[i]->expires_ns <= now) {
+            client_close(exporter, exporter->clients[i]);
+        }
+    }
+
+    exporter_body_t *back = exporter->front == &exporter->bodies[0] ?
+                            &exporter->bodies[1] : &exporter->bodies[0];
+    if (back->users > 0) {
+        exporter->stale++;
+        return;
+    }
+    if (!render(back, table, wall)) {
+        fprintf(stderr, "Warning: Cannot render metrics: %s\n", strerror(errno));
+        return;
+    }
+    exporter->front = back;
+}
+
+/* Connections */
+
+static void client_close(exporter_t *exporter, exporter_client_t *client) {
+    if (client->body) {
+        client->body->users--;
+    }
+    event_loop_remove(exporter->loop, &client->source);
+    close(client->source.fd);
+    exporter_client_t *last = exporter->clients[--exporter->count];
+    exporter->clients[client->index] = last;
+    last->index = client->index;
+    free(client);
+}
+
+/**
+ * Pick the response once the request head is complete. Only the request
+ * line matters; the connection closes after one response
+ */
+static void client_route(exporter_t *exporter, exporter_client_t *client) {
+    static const char get_metrics[] = "GET /metrics";
+    const char *request = client->request;
+    const char *next = request + sizeof(get_metrics) - 1;
+
+    if (strncmp(request, get_metrics, sizeof(get_metrics) - 1) != 0 ||
+        (*next != ' ' && *next != '?')) {
+        client->response = not_found;
+        client->response_len = sizeof(not_found) - 1;
+    } else if (!exporter->front) {
+        client->response = unavailable;
+        client->response_len = sizeof(unavailable) - 1;
+    } else {
+        client->body = exporter->front;
+        client->body->users++;
+        client->response = client->body->data + client->body->start;
+        client->response_len = client->body->len - client->body->start;
+        exporter->scrapes++;
+    }
+}
+
+/* False once the client is done with, one way or another */
+static bool client_read(exporter_t *exporter, exporter_client_t *client) {
+    size_t room = sizeof(client->request) - 1 - client->request_len;
+    if (room == 0) {
+        return false;
+    }
+    ssize_t n = recv(client->source.fd, client->request + client->request_len, room, 0);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        return false;
+    }
+    if (n > 0) {
+        client->request_len += (size_t)n;
+        client->request[client->request_len] = '\0';
+        if (strstr(client->request, "\r\n\r\n") || strstr(client->request, "\n\n")) {
+            client_route(exporter, client);
+        }
+    }
+    return true;
+}
+
+static bool client_write(exporter_client_t *client) {
+    ssize_t n = send(client->source.fd, client->response + client->sent,
+                     client->response_len - client->sent, MSG_NOSIGNAL);
+    if (n < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    client->sent += (size_t)n;
+    return client->sent < client->response_len;
+}
+
+/**
+ * Read the request, then send the response straight away; only a
+ * response too big for the socket buffer waits for EPOLLOUT
+ */
+static void on_client(event_source_t *source, uint32_t events) {
+    exporter_client_t *client = source->ctx;
+    exporter_t *exporter = client->exporter;
+    bool waiting = client->response != NULL;
+    bool keep = !(events & EPOLLERR);
+
+    if (keep && !client->response) {
+        keep = client_read(exporter, client);
+    }
+    if (keep && client->response) {
+        keep = client_write(client);
+        if (keep && !waiting) {
+            keep = event_loop_modify(exporter->loop, source, EPOLLOUT);
+        }
+    }
+    if (!keep) {
+        client_close(exporter, client);
+    }
+}
+
+static void on_listen(event_source_t *source, uint32_t events) {
+    exporter_t *exporter = source->ctx;
+    (void)events;
+
+    for (;;) {
+        int fd = accept(source->fd, NULL, NULL);
+        if (fd < 0) {
+            return;
+        }
+        if (exporter->count >= EXPORTER_MAX_CLIENTS || !set_nonblocking(fd)) {
+            exporter->rejected++;
+            close(fd);
+            continue;
+        }
+        if (exporter->count == exporter->capacity) {
+            size_t capacity = exporter->capacity ? exporter->capacity * 2 : 16;
+            exporter_client_t **clients = realloc(exporter->clients,
+                                                  capacity * sizeof(*clients));
+            if (!clients) {
+                exporter->rejected++;
+                close(fd);
+                continue;
+            }
+            exporter->clients = clients;
+            exporter->capacity = capacity;
+        }
+        exporter_client_t *client = malloc(sizeof(*client));
+        if (!client) {
+            exporter->rejected++;
+            close(fd);
+            continue;
+        }
+        client->source.fd = fd;
+        client->source.callback = on_client;
+        client->source.ctx = client;
+        client->exporter = exporter;
+        client->index = exporter->count;
+        client->response = NULL;
+        client->response_len = 0;
+        client->sent = 0;
+        client->body = NULL;
+        client->expires_ns = monotonic_ns() + EXPORTER_TIMEOUT_NS;
+        client->request_len = 0;
+        if (!event_loop_add(exporter->loop, &client->source, EPOLLIN)) {
+            exporter->rejected++;
+            close(fd);
+            free(client);
+            continue;
+        }
+        exporter->clients[exporter->count++] = client;
+    }
+}
+
+void exporter_print_summary(const exporter_t *exporter, FILE *out) {
+    fprintf(out, "Metrics: %llu scrapes served", (unsigned long long)exporter->scrapes);
+    if (exporter->rejected) {
+        fprintf(out, ", %llu connections rejected", (unsigned long long)exporter->rejected);
+    }
+    if (exporter->stale) {
+        fprintf(out, ", %llu ticks not published (slow scrapers)",
+                (unsigned long long)exporter->stale);
+    }
+    fprintf(out, "\n");
+}
+
+void exporter_close(exporter_t *exporter) {
+    while (exporter->count) {
+        client_close(exporter, exporter->clients[exporter->count - 1]);
+    }
+    if (exporter->listener.fd >= 0) {
+        event_loop_remove(exporter->loop, &exporter->listener);
+        close(exporter->listener.fd);
+        exporter->listener.fd = -1;
+    }
+    free(exporter->clients);
+    free(exporter->bodies[0].data);
+    free(exporter->bodies[1].data);
+    memset(exporter->bodies, 0, sizeof(exporter->bodies));
+    exporter->clients = NULL;
+    exporter->front = NULL;
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "iface_soa.h"
+#include "event_loop.h"
+
+#define EXPORTER_DEFAULT_HOST "127.0.0.1"
+#define EXPORTER_MAX_CLIENTS 1024
+#define EXPORTER_REQUEST_MAX 1024
+/* Room in front of the body for the status line and headers */
+#define EXPORTER_HEADER_RESERVE 128
+/* Connections not finished with in this time are dropped */
+#define EXPORTER_TIMEOUT_NS (UINT64_C(10) * NSEC_PER_SEC)
+
+/*
+ * One complete HTTP response, rendered once per tick. A body stays
+ * pinned while any client is still sending it
+ */
+typedef struct {
+    char *data;
+    size_t start;
+    size_t len;
+    size_t capacity;
+    unsigned users;
+} exporter_body_t;
+
+typedef struct exporter exporter_t;
+
+typedef struct {
+    event_source_t source;
+    exporter_t *exporter;
+    size_t index;
+    const char *response;
+    size_t response_len;
+    size_t sent;
+    exporter_body_t *body;
+    uint64_t expires_ns;
+    size_t request_len;
+    char request[EXPORTER_REQUEST_MAX];
+} exporter_client_t;
+
+struct exporter {
+    event_source_t listener;
+    event_loop_t *loop;
+    exporter_client_t **clients;
+    size_t count;
+    size_t capacity;
+    exporter_body_t bodies[2];
+    exporter_body_t *front;
+    uint64_t scrapes;
+    uint64_t rejected;
+    uint64_t stale;
+};
+
+bool exporter_open(exporter_t *exporter, const char *address, event_loop_t *loop);
+void exporter_publish(exporter_t *exporter, const iface_soa_t *table,
+                      const struct timespec *wall);
+void exporter_print_summary(const exporter_t *exporter, FILE *out);
+void exporter_close(exporter_t *exporter);
+
+#endif /* EXPORTER_H */
@@ -0,0 +1,484 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "history.h"
+#include "timestamp.h"
+#include "rate.h"
+
+#define HISTORY_PAGE 4096
+#define HISTORY_ALIGN 64
+
+static inline size_t round_up(size_t n, size_t align) {
+    return (n + align - 1) / align * align;
+}
+
+static inline size_t names_offset(void) {
+    return round_up(sizeof(history_header_t), HISTORY_ALIGN);
+}
+
+static inline char (*header_names(history_header_t *header))[MAX_IFACE_LEN] {
+    return (char (*)[MAX_IFACE_LEN])((char *)header + names_offset());
+}
+
+static inline history_slot_t *header_slot(history_header_t *header, uint64_t tick) {
+    char *base = (char *)header + header->header_size;
+    return (history_slot_t *)(base + (size_t)(tick % header->slot_count) * header->slot_size);
+}
+
+static inline history_entry_t *slot_entries(history_slot_t *slot) {
+    return (history_entry_t *)(slot + 1);
+}
+
+/**
+ * True if the existing header has exactly this geometry and lists the
+ * table's interfaces in order, so that its ticks can be kept
+ */
+static bool history_matches(history_header_t *header, size_t map_size, uint32_t header_size,
+                            uint32_t slot_size, uint64_t slot_count, uint64_t interval_ns,
+                            uint32_t iface_capacity, const iface_soa_t *table) {
+    if (map_size < sizeof(*header) || memcmp(header->magic, HISTORY_MAGIC, 4) != 0 ||
+        header->version != HISTORY_VERSION || header->header_size != header_size ||
+        header->slot_size != slot_size || header->slot_count != slot_count ||
+        header->interval_ns != interval_ns || header->iface_capacity != iface_capacity ||
+        header->iface_count != table->count) {
+        return false;
+    }
+    char (*names)[MAX_IFACE_LEN] = header_names(header);
+    for (size_t i = 0; i < table->count; i++) {
+        if (strncmp(names[i], iface_soa_name(table, i), MAX_IFACE_LEN) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * A writer killed between seq_begin() and seq_end() leaves a seq odd, and
+ * the next seq_begin() would make it even in the middle of a write. Round
+ * every odd seq up before writing again, dropping the tick of such a slot
+ */
+static void history_repair(history_header_t *header) {
+    uint64_t seq = atomic_load_explicit(&header->seq, memory_order_relaxed);
+    if (seq & 1) {
+        atomic_store_explicit(&header->seq, seq + 1, memory_order_release);
+    }
+    for (uint64_t i = 0; i < header->slot_count; i++) {
+        history_slot_t *slot = header_slot(header, i);
+        seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+        if (seq & 1) {
+            slot->tick = UINT64_MAX;
+            atomic_store_explicit(&slot->seq, seq + 1, memory_order_release);
+        }
+    }
+}
+
+/**
+ * Map the history file, sized for span / interval ticks of up to
+ * iface_capacity interfaces. A file left by an earlier run with the same
+ * geometry and interfaces is resumed; anything else is recreated
+ * The space is allocated up front, so the file never grows afterwards
+ */
+bool history_open(history_t *history, const char *path, uint64_t span_ns, uint64_t interval_ns,
+                  const iface_soa_t *table, size_t iface_capacity) {
+    memset(history, 0, sizeof(*history));
+    history->fd = -1;
+
+    if (iface_capacity < table->count) {
+        iface_capacity = table->count;
+    }
+    uint64_t slot_count = (span_ns + interval_ns - 1) / interval_ns;
+    if (slot_count < 2) {
+        slot_count = 2;
+    }
+    size_t header_size = round_up(names_offset() + iface_capacity * MAX_IFACE_LEN, HISTORY_PAGE);
+    size_t slot_size = round_up(sizeof(history_slot_t) + iface_capacity * sizeof(history_entry_t),
+                                HISTORY_ALIGN);
+    if (slot_count > (SIZE_MAX - header_size) / slot_size) {
+        fprintf(stderr, "Error: History span is too long for the interval\n");
+        return false;
+    }
+    size_t map_size = header_size + (size_t)slot_count * slot_size;
+
+    history->restart = calloc(iface_capacity ? iface_capacity : 1, 1);
+    if (!history->restart) {
+        fprintf(stderr, "Error: Cannot allocate history state: %s\n", strerror(errno));
+        return false;
+    }
+    history->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (history->fd < 0) {
+        fprintf(stderr, "Error: Cannot open %s: %s\n", path, strerror(errno));
+        history_close(history);
+        return false;
+    }
+
+    struct stat st;
+    bool resume = fstat(history->fd, &st) == 0 && (size_t)st.st_size == map_size;
+    if (!resume) {
+        /* Truncating first leaves every page zeroed */
+        int rc = 0;
+        if (ftruncate(history->fd, 0) != 0 || ftruncate(history->fd, (off_t)map_size) != 0) {
+            rc = errno;
+        } else {
+            rc = posix_fallocate(history->fd, 0, (off_t)map_size);
+        }
+        if (rc != 0) {
+            fprintf(stderr, "Error: Cannot allocate %zu bytes for %s: %s\n",
+                    map_size, path, strerror(rc));
+            history_close(history);
+            return false;
+        }
+    }
+
+    history->map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, history->fd, 0);
+    if (history->map == MAP_FAILED) {
+        fprintf(stderr, "Error: Cannot map %s: %s\n", path, strerror(errno));
+        history->map = NULL;
+        history_close(history);
+        return false;
+    }
+    history->map_size = map_size;
+    history->header = history->map;
+
+    history_header_t *header = history->header;
+    if (resume && history_matches(header, map_size, (uint32_t)header_size, (uint32_t)slot_size,
+                                  slot_count, interval_ns, (uint32_t)iface_capacity, table)) {
+        history_repair(header);
+        return true;
+    }
+    if (resume) {
+        memset(history->map, 0, map_size);
+    }
+
+    header->version = HISTORY_VERSION;
+    header->header_size = (uint32_t)header_size;
+    header->slot_size = (uint32_t)slot_size;
+    header->interval_ns = interval_ns;
+    header->slot_count = slot_count;
+    header->iface_capacity = (uint32_t)iface_capacity;
+    atomic_store_explicit(&header->cursor, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    /* Readers check the magic last */
+    memcpy(header->magic, HISTORY_MAGIC, 4);
+    return true;
+}
+
+void history_close(history_t *history) {
+    if (history->map) {
+        munmap(history->map, history->map_size);
+        history->map = NULL;
+    }
+    if (history->fd >= 0) {
+        close(history->fd);
+        history->fd = -1;
+    }
+    free(history->restart);
+    history->restart = NULL;
+}
+
+static inline void seq_begin(_Atomic uint64_t *seq) {
+    uint64_t s = atomic_load_explicit(seq, memory_order_relaxed);
+    atomic_store_explicit(seq, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static inline void seq_end(_Atomic uint64_t *seq) {
+    uint64_t s = atomic_load_explicit(seq, memory_order_relaxed);
+    atomic_store_explicit(seq, s + 1, memory_order_release);
+}
+
+/**
+ * Store one tick: the counters of every interface in the table, flagged
+ * valid if the tick saw it. No msync(); the page cache writes it back
+ */
+void history_append(history_t *history, const iface_soa_t *table, const struct timespec *wall) {
+    history_header_t *header = history->header;
+    size_t count = table->count;
+
+    if (count > header->iface_capacity) {
+        if (!history->overflow_warned) {
+            fprintf(stderr, "Warning: History holds %u interfaces; later ones are not kept\n",
+                    header->iface_capacity);
+            history->overflow_warned = true;
+        }
+        count = header->iface_capacity;
+    }
+
+    if (count > header->iface_count) {
+        char (*names)[MAX_IFACE_LEN] = header_names(header);
+        seq_begin(&header->seq);
+        for (size_t i = header->iface_count; i < count; i++) {
+            const char *name = iface_soa_name(table, i);
+            memset(names[i], 0, MAX_IFACE_LEN);
+            memcpy(names[i], name, strlen(name));
+        }
+        header->iface_count = (uint32_t)count;
+        seq_end(&header->seq);
+    }
+
+    uint64_t tick = atomic_load_explicit(&header->cursor, memory_order_relaxed);
+    history_slot_t *slot = header_slot(header, tick);
+    history_entry_t *entries = slot_entries(slot);
+
+    seq_begin(&slot->seq);
+    slot->tick = tick;
+    slot->time_ns = (uint64_t)wall->tv_sec * NSEC_PER_SEC + (uint64_t)wall->tv_nsec;
+    /* Entries keep the column order, so each column is one strided copy */
+    for (size_t i = 0; i < count; i++) {
+        entries[i].valid = table->seen[i];
+        if (table->seen[i] && history->restart[i]) {
+            entries[i].valid = HISTORY_RESTARTED;
+            history->restart[i] = 0;
+        }
+    }
+    for (int c = 0; c < IFACE_COUNTERS; c++) {
+        const uint64_t *column = table->current[c];
+        for (size_t i = 0; i < count; i++) {
+            entries[i].counters[c] = column[i];
+        }
+    }
+    seq_end(&slot->seq);
+
+    atomic_store_explicit(&header->cursor, tick + 1, memory_order_release);
+}
+
+/**
+ * Store the new name of an interface already in the name table
+ */
+void history_rename(history_t *history, const iface_soa_t *table, size_t id) {
+    history_header_t *header = history->header;
+    if (id >= header->iface_count) {
+        return;
+    }
+    char (*names)[MAX_IFACE_LEN] = header_names(header);
+    const char *name = iface_soa_name(table, id);
+    seq_begin(&header->seq);
+    memset(names[id], 0, MAX_IFACE_LEN);
+    memcpy(names[id], name, strlen(name));
+    seq_end(&header->seq);
+}
+
+/**
+ * Flag the next entry of an interface as the start of a new baseline
+ */
+void history_restart(history_t *history, size_t id) {
+    if (id < history->header->iface_capacity) {
+        history->restart[id] = 1;
+    }
+}
+
+/* Reader */
+
+/* Attempts before a seq that stays odd is taken for a dead writer */
+#define HISTORY_READ_RETRIES 1000
+
+/**
+ * Copy size bytes guarded by seq; false if a write overlapped the copy
+ */
+static bool seq_copy(_Atomic uint64_t *seq, void *dst, const void *src, size_t size) {
+    uint64_t before = atomic_load_explicit(seq, memory_order_acquire);
+    if (before & 1) {
+        return false;
+    }
+    memcpy(dst, src, size);
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(seq, memory_order_relaxed) == before;
+}
+
+/**
+ * seq_copy() until it succeeds, yielding to the writer in between
+ * Returns false if seq is still odd or moving after HISTORY_READ_RETRIES
+ */
+static bool seq_read(_Atomic uint64_t *seq, void *dst, const void *src, size_t size) {
+    for (int i = 0; i < HISTORY_READ_RETRIES; i++) {
+        if (seq_copy(seq, dst, src, size)) {
+            return true;
+        }
+        sched_yield();
+    }
+    return false;
+}
+
+static void entry_stats(const history_entry_t *entry, net_stats_t *stats) {
+    stats->rx_bytes = entry->counters[0];
+    stats->rx_packets = entry->counters[1];
+    stats->rx_errors = entry->counters[2];
+    stats->rx_drops = entry->counters[3];
+    stats->tx_bytes = entry->counters[4];
+    stats->tx_packets = entry->counters[5];
+    stats->tx_errors = entry->counters[6];
+    stats->tx_drops = entry->counters[7];
+    stats->valid = entry->valid != 0;
+}
+
+/**
+ * Print every tick still in the ring, oldest first, while the monitor
+ * may be writing to it
+ */
+bool history_dump(const char *path, output_format_t format) {
+    bool ok = false;
+    struct stat st;
+    output_t out = {0};
+    timestamp_cache_t clock;
+    char (*names)[MAX_IFACE_LEN] = NULL;
+    char *copy = NULL;
+    char *previous = NULL;
+    void *map = MAP_FAILED;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < HISTORY_PAGE) {
+        goto invalid;
+    }
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Error: Cannot map %s: %s\n", path, strerror(errno));
+        goto out;
+    }
+
+    history_header_t *header = map;
+    if (memcmp(header->magic, HISTORY_MAGIC, 4) != 0 || header->version != HISTORY_VERSION ||
+        header->slot_count == 0 || header->slot_size < sizeof(history_slot_t) +
+        header->iface_capacity * sizeof(history_entry_t) ||
+        header->header_size < names_offset() + header->iface_capacity * MAX_IFACE_LEN ||
+        (size_t)st.st_size != header->header_size + header->slot_count * header->slot_size) {
+        goto invalid;
+    }
+
+    size_t capacity = header->iface_capacity;
+    size_t names_size = capacity * MAX_IFACE_LEN;
+    names = malloc(names_size ? names_size : 1);
+    copy = malloc(header->slot_size);
+    previous = calloc(1, header->slot_size);
+    if (!names || !copy || !previous) {
+        fprintf(stderr, "Error: Cannot allocate history buffers: %s\n", strerror(errno));
+        goto out;
+    }
+
+    uint32_t count = 0;
+    bool named = false;
+    for (int i = 0; i < HISTORY_READ_RETRIES && !named; i++) {
+        count = header->iface_count;
+        named = seq_copy(&header->seq, names, header_names(header), names_size);
+        if (!named) {
+            sched_yield();
+        }
+    }
+    if (!named) {
+        fprintf(stderr, "Error: The name table of %s is being written or corrupt\n", path);
+        goto out;
+    }
+    if (count > capacity) {
+        goto invalid;
+    }
+
+    timestamp_cache_init(&clock, header->interval_ns < NSEC_PER_SEC);
+    if (!output_init(&out, STDOUT_FILENO, timestamp_width(&clock))) {
+        goto out;
+    }
+    if (format == OUTPUT_TABLE) {
+        output_table_header(&out, false);
+    }
+
+    uint64_t cursor = atomic_load_explicit(&header->cursor, memory_order_acquire);
+    uint64_t first = cursor > header->slot_count ? cursor - header->slot_count : 0;
+    history_slot_t *prev_slot = (history_slot_t *)previous;
+    history_slot_t *cur_slot = (history_slot_t *)copy;
+    bool have_previous = false;
+
+    for (uint64_t tick = first; tick < cursor; tick++) {
+        history_slot_t *slot = header_slot(header, tick);
+        if (!seq_read(&slot->seq, copy, slot, header->slot_size)) {
+            fprintf(stderr, "Warning: Skipping tick %llu: slot being written or corrupt\n",
+                    (unsigned long long)tick);
+            have_previous = false;
+            continue;
+        }
+        /* Overwritten since the cursor was read */
+        if (cur_slot->tick != tick) {
+            have_previous = false;
+            continue;
+        }
+
+        struct timespec when = {
+            .tv_sec = (time_t)(cur_slot->time_ns / NSEC_PER_SEC),
+            .tv_nsec = (long)(cur_slot->time_ns % NSEC_PER_SEC),
+        };
+        struct timespec then = {
+            .tv_sec = (time_t)(prev_slot->time_ns / NSEC_PER_SEC),
+            .tv_nsec = (long)(prev_slot->time_ns % NSEC_PER_SEC),
+        };
+        double elapsed = timespec_diff(&then, &when);
+        const char *timestamp = format == OUTPUT_TABLE ? timestamp_format(&clock, &when) : NULL;
+
+        for (size_t i = 0; i < count; i++) {
+            net_stats_t current = {0}, before = {0};
+            entry_stats(&slot_entries(cur_slot)[i], &current);
+            if (!current.valid) {
+                continue;
+            }
+            memcpy(current.interface, names[i], MAX_IFACE_LEN);
+            entry_stats(&slot_entries(prev_slot)[i], &before);
+            before.valid = before.valid && have_previous &&
+                           slot_entries(cur_slot)[i].valid != HISTORY_RESTARTED;
+
+            const net_stats_t *prior = before.valid ? &before : NULL;
+            if (format == OUTPUT_JSON) {
+                output_json_row(&out, &when, &current, prior, elapsed);
+            } else {
+                output_stats_row(&out, timestamp, &current, prior, elapsed);
+            }
+        }
+
+        char *swap = copy;
+        copy = previous;
+        previous = swap;
+        prev_slot = (history_slot_t *)previous;
+        cur_slot = (history_slot_t *)copy;
+        have_previous = true;
+    }
+
+    ok = output_flush(&out);
+    goto out;
+
+invalid:
+    fprintf(stderr, "Error: %s is not a netstat_monitor history file\n", path);
+out:
+    output_free(&out);
+    free(names);
+    free(copy);
+    free(previous);
+    if (map != MAP_FAILED) {
+        munmap(map, (size_t)st.st_size);
+    }
+    close(fd);
+    return ok;
+}
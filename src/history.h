@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "netstat_monitor.h"
+#include "iface_soa.h"
+#include "output.h"
+
+#define HISTORY_MAGIC "NSMH"
+#define HISTORY_VERSION 1
+#define HISTORY_DEFAULT_SPAN_NS (UINT64_C(3600) * NSEC_PER_SEC)
+#define HISTORY_COUNTERS 8
+#define HISTORY_RESTARTED 2
+
+/*
+ * History file layout, in native byte order:
+ *
+ *   history_header_t, then iface_capacity names of MAX_IFACE_LEN bytes,
+ *   padded to header_size; then slot_count slots of slot_size bytes, each
+ *   a history_slot_t followed by iface_capacity history_entry_t
+ *
+ * An entry's valid is 0 if the tick did not see the interface, 1 if it
+ * did, and HISTORY_RESTARTED if it did but the link is not the one of the
+ * entries before, so no rate spans them
+ *
+ * Tick n goes to slot n % slot_count. The writer brackets every change
+ * with the seqlock of the slot, or of the header for the name table: it
+ * makes seq odd, writes, then makes it even again, and only then advances
+ * cursor. A reader copies what it needs and keeps the copy only if seq
+ * was even and unchanged across it
+ */
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t slot_size;
+    uint64_t interval_ns;
+    uint64_t slot_count;
+    uint32_t iface_capacity;
+    uint32_t iface_count;
+    _Atomic uint64_t seq;
+    _Atomic uint64_t cursor;
+} history_header_t;
+
+typedef struct {
+    _Atomic uint64_t seq;
+    uint64_t tick;
+    uint64_t time_ns;
+} history_slot_t;
+
+typedef struct {
+    uint64_t counters[HISTORY_COUNTERS];
+    uint64_t valid;
+} history_entry_t;
+
+typedef struct {
+    int fd;
+    void *map;
+    size_t map_size;
+    history_header_t *header;
+    /* Per interface: the next entry starts a new baseline */
+    uint8_t *restart;
+    bool overflow_warned;
+} history_t;
+
+bool history_open(history_t *history, const char *path, uint64_t span_ns, uint64_t interval_ns,
+                  const iface_soa_t *table, size_t iface_capacity);
+void history_append(history_t *history, const iface_soa_t *table, const struct timespec *wall);
+void history_rename(history_t *history, const iface_soa_t *table, size_t id);
+void history_restart(history_t *history, size_t id);
+void history_close(history_t *history);
+
+bool history_dump(const char *path, output_format_t format);
+
+#endif /* HISTORY_H */
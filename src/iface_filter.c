@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fnmatch.h>
+
+#include "iface_filter.h"
+
+/**
+ * Compile a pattern and append it to the include or exclude list
+ * Returns false, with the reason on stderr, if it does not compile
+ */
+bool iface_filter_add(iface_filter_t *filter, const char *pattern, bool exclude) {
+    iface_pattern_t **list = exclude ? &filter->exclude : &filter->include;
+    size_t *count = exclude ? &filter->exclude_count : &filter->include_count;
+    size_t prefix = strlen(IFACE_FILTER_REGEX_PREFIX);
+
+    iface_pattern_t *grown = realloc(*list, (*count + 1) * sizeof(*grown));
+    if (!grown) {
+        fprintf(stderr, "Error: Cannot store pattern: %s\n", strerror(errno));
+        return false;
+    }
+    *list = grown;
+
+    iface_pattern_t *entry = &grown[*count];
+    entry->text = pattern;
+    entry->is_regex = strncmp(pattern, IFACE_FILTER_REGEX_PREFIX, prefix) == 0;
+    if (entry->is_regex) {
+        /* Anchor, so that bond[0-9]+ does not also select xbond0 */
+        const char *body = pattern + prefix;
+        size_t len = strlen(body) + 5;
+        char *anchored = malloc(len);
+        if (!anchored) {
+            fprintf(stderr, "Error: Cannot store pattern: %s\n", strerror(errno));
+            return false;
+        }
+        snprintf(anchored, len, "^(%s)$", body);
+        int rc = regcomp(&entry->regex, anchored, REG_EXTENDED | REG_NOSUB);
+        free(anchored);
+        if (rc != 0) {
+            char reason[128];
+            regerror(rc, &entry->regex, reason, sizeof(reason));
+            fprintf(stderr, "Error: Invalid regex '%s': %s\n", body, reason);
+            return false;
+        }
+    }
+    (*count)++;
+    return true;
+}
+
+static bool pattern_match(const iface_pattern_t *pattern, const char *name) {
+    if (pattern->is_regex) {
+        return regexec(&pattern->regex, name, 0, NULL, 0) == 0;
+    }
+    return fnmatch(pattern->text, name, 0) == 0;
+}
+
+/**
+ * Evaluate the patterns for one name. This is the slow path: callers
+ * cache the decision per interface and only ask again for new names
+ */
+bool iface_filter_match(const iface_filter_t *filter, const char *name) {
+    bool selected = filter->include_count == 0;
+    for (size_t i = 0; i < filter->include_count && !selected; i++) {
+        selected = pattern_match(&filter->include[i], name);
+    }
+    for (size_t i = 0; i < filter->exclude_count && selected; i++) {
+        selected = !pattern_match(&filter->exclude[i], name);
+    }
+    return selected;
+}
+
+static void free_patterns(iface_pattern_t *patterns, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (patterns[i].is_regex) {
+            regfree(&patterns[i].regex);
+        }
+    }
+    free(patterns);
+}
+
+void iface_filter_free(iface_filter_t *filter) {
+    free_patterns(filter->include, filter->include_count);
+    free_patterns(filter->exclude, filter->exclude_count);
+    memset(filter, 0, sizeof(*filter));
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef IFACE_FILTER_H
+#define IFACE_FILTER_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <regex.h>
+
+/* Prefix that makes a pattern a POSIX extended regex instead of a glob */
+#define IFACE_FILTER_REGEX_PREFIX "re:"
+
+typedef struct {
+    const char *text;
+    bool is_regex;
+    regex_t regex;
+} iface_pattern_t;
+
+/*
+ * Include and exclude patterns, compiled once. A name is selected if it
+ * matches any include pattern (or there are none) and no exclude pattern
+ * Globs use fnmatch(); regexes must match the whole name
+ */
+typedef struct {
+    iface_pattern_t *include;
+    size_t include_count;
+    iface_pattern_t *exclude;
+    size_t exclude_count;
+} iface_filter_t;
+
+bool iface_filter_add(iface_filter_t *filter, const char *pattern, bool exclude);
+bool iface_filter_match(const iface_filter_t *filter, const char *name);
+void iface_filter_free(iface_filter_t *filter);
+
+static inline bool iface_filter_empty(const iface_filter_t *filter) {
+    return filter->include_count == 0 && filter->exclude_count == 0;
+}
+
+#endif /* IFACE_FILTER_H */
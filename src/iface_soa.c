@@ -0,0 +1,271 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "iface_soa.h"
+
+/* Resize one column, leaving it untouched on failure */
+#define GROW(column, capacity) do { \
+        void *grown = realloc((column), sizeof(*(column)) * (capacity)); \
+        if (!grown) { \
+            fprintf(stderr, "Error: Cannot grow interface table: %s\n", strerror(errno)); \
+            return false; \
+        } \
+        (column) = grown; \
+    } while (0)
+
+static bool soa_reserve(iface_soa_t *soa, size_t count) {
+    if (count <= soa->capacity) {
+        return true;
+    }
+    size_t capacity = soa->capacity ? soa->capacity * 2 : 64;
+    while (capacity < count) {
+        capacity *= 2;
+    }
+
+    GROW(soa->name, capacity);
+    GROW(soa->time_ns, capacity);
+    GROW(soa->previous_ns, capacity);
+    GROW(soa->elapsed, capacity);
+    GROW(soa->inverse, capacity);
+    GROW(soa->seen, capacity);
+    GROW(soa->has_previous, capacity);
+    GROW(soa->burst, capacity);
+    for (int c = 0; c < IFACE_COUNTERS; c++) {
+        GROW(soa->current[c], capacity);
+        GROW(soa->previous[c], capacity);
+        GROW(soa->delta[c], capacity);
+        GROW(soa->rate[c], capacity);
+    }
+    soa->capacity = capacity;
+    return true;
+}
+
+/**
+ * Copy a name into the pool; returns its offset, or UINT32_MAX on failure
+ */
+static uint32_t intern(iface_soa_t *soa, const char *name, size_t len) {
+    if (soa->pool_len + len + 1 > soa->pool_capacity) {
+        size_t capacity = soa->pool_capacity ? soa->pool_capacity * 2 : 1024;
+        while (capacity < soa->pool_len + len + 1) {
+            capacity *= 2;
+        }
+        char *pool = realloc(soa->pool, capacity);
+        if (!pool) {
+            fprintf(stderr, "Error: Cannot grow interface name pool: %s\n", strerror(errno));
+            return UINT32_MAX;
+        }
+        soa->pool = pool;
+        soa->pool_capacity = capacity;
+    }
+    uint32_t offset = (uint32_t)soa->pool_len;
+    memcpy(soa->pool + offset, name, len);
+    soa->pool[offset + len] = '\0';
+    soa->pool_len += len + 1;
+    return offset;
+}
+
+/**
+ * Append a slot; its id is the previous count. The name need not be
+ * NUL-terminated and is truncated to MAX_IFACE_LEN - 1
+ */
+bool iface_soa_add(iface_soa_t *soa, const char *name, size_t len) {
+    if (len >= MAX_IFACE_LEN) {
+        len = MAX_IFACE_LEN - 1;
+    }
+    if (!soa_reserve(soa, soa->count + 1)) {
+        return false;
+    }
+    if (!soa->kernel) {
+        soa->kernel = iface_soa_kernel_get(NULL);
+    }
+    uint32_t offset = intern(soa, name, len);
+    if (offset == UINT32_MAX) {
+        return false;
+    }
+
+    size_t id = soa->count++;
+    soa->name[id] = offset;
+
+    for (int c = 0; c < IFACE_COUNTERS; c++) {
+        soa->current[c][id] = 0;
+        soa->previous[c][id] = 0;
+    }
+    soa->time_ns[id] = 0;
+    soa->previous_ns[id] = 0;
+    soa->seen[id] = 0;
+    soa->has_previous[id] = 0;
+    burst_reset(&soa->burst[id]);
+    return true;
+}
+
+/**
+ * Point a slot at a new name. A name that fits is overwritten in place;
+ * a longer one goes to the end of the pool
+ */
+bool iface_soa_rename(iface_soa_t *soa, size_t id, const char *name, size_t len) {
+    if (len >= MAX_IFACE_LEN) {
+        len = MAX_IFACE_LEN - 1;
+    }
+    char *old = soa->pool + soa->name[id];
+    if (len <= strlen(old)) {
+        memcpy(old, name, len);
+        old[len] = '\0';
+        return true;
+    }
+    uint32_t offset = intern(soa, name, len);
+    if (offset == UINT32_MAX) {
+        return false;
+    }
+    soa->name[id] = offset;
+    return true;
+}
+
+/**
+ * Drop a slot's baseline, so that its next sample starts afresh
+ */
+void iface_soa_restart(iface_soa_t *soa, size_t id) {
+    soa->has_previous[id] = 0;
+    burst_reset(&soa->burst[id]);
+}
+
+/*
+ * Slots per block of iface_soa_compute(): the block's reciprocals stay in
+ * L1 while all eight counter columns are run against them
+ */
+#define IFACE_SOA_BLOCK 512
+
+static void scalar_inverse(const int64_t *restrict now, const int64_t *restrict then,
+                           const uint8_t *restrict seen, const uint8_t *restrict has_previous,
+                           double *restrict elapsed, double *restrict inverse, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        int64_t ns = now[i] - then[i];
+        bool valid = (seen[i] & has_previous[i]) && ns > 0;
+        double dt = (double)ns;
+        elapsed[i] = valid ? dt * 1e-9 : 0.0;
+        inverse[i] = valid ? 1e9 / dt : 0.0;
+    }
+}
+
+/* safe_delta() without the branch: a wrapped counter adds 2^32 */
+static void scalar_rates(const uint64_t *restrict cur, const uint64_t *restrict prev,
+                         const double *restrict inverse, uint64_t *restrict delta,
+                         double *restrict rate, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        uint64_t d = cur[i] - prev[i] + ((uint64_t)(cur[i] < prev[i]) << 32);
+        delta[i] = d;
+        rate[i] = (double)d * inverse[i];
+    }
+}
+
+const iface_soa_kernel_t iface_soa_kernel_scalar = {
+    .name = "scalar",
+    .inverse = scalar_inverse,
+    .rates = scalar_rates,
+};
+
+/**
+ * Fill the delta, rate and elapsed columns for the latest sample. Slots
+ * without both a current and a previous sample get zero rates
+ * Elapsed time is inverted once per slot and shared by every counter, so
+ * the per-counter work is a subtraction and a multiplication
+ */
+void iface_soa_compute(iface_soa_t *soa) {
+    const iface_soa_kernel_t *kernel = soa->kernel;
+
+    for (size_t start = 0; start < soa->count; start += IFACE_SOA_BLOCK) {
+        size_t n = soa->count - start < IFACE_SOA_BLOCK ? soa->count - start : IFACE_SOA_BLOCK;
+
+        kernel->inverse(soa->time_ns + start, soa->previous_ns + start, soa->seen + start,
+                        soa->has_previous + start, soa->elapsed + start, soa->inverse + start, n);
+        for (int c = 0; c < IFACE_COUNTERS; c++) {
+            kernel->rates(soa->current[c] + start, soa->previous[c] + start,
+                          soa->inverse + start, soa->delta[c] + start, soa->rate[c] + start, n);
+        }
+    }
+}
+
+/**
+ * Make the latest sample the previous one of every slot. The columns
+ * are swapped, not copied; a slot missing from the sample loses its
+ * baseline, so that its next rates start afresh
+ */
+void iface_soa_advance(iface_soa_t *soa) {
+    for (int c = 0; c < IFACE_COUNTERS; c++) {
+        uint64_t *swap = soa->previous[c];
+        soa->previous[c] = soa->current[c];
+        soa->current[c] = swap;
+    }
+    int64_t *swap = soa->previous_ns;
+    soa->previous_ns = soa->time_ns;
+    soa->time_ns = swap;
+    memcpy(soa->has_previous, soa->seen, soa->count);
+}
+
+static void gather(const iface_soa_t *soa, size_t id, uint64_t *const columns[],
+                   int64_t time_ns, bool valid, net_stats_t *stats) {
+    const char *name = iface_soa_name(soa, id);
+    memcpy(stats->interface, name, strlen(name) + 1);
+    stats->rx_bytes = columns[IFACE_RX_BYTES][id];
+    stats->rx_packets = columns[IFACE_RX_PACKETS][id];
+    stats->rx_errors = columns[IFACE_RX_ERRORS][id];
+    stats->rx_drops = columns[IFACE_RX_DROPS][id];
+    stats->tx_bytes = columns[IFACE_TX_BYTES][id];
+    stats->tx_packets = columns[IFACE_TX_PACKETS][id];
+    stats->tx_errors = columns[IFACE_TX_ERRORS][id];
+    stats->tx_drops = columns[IFACE_TX_DROPS][id];
+    stats->timestamp.tv_sec = (time_t)(time_ns / (int64_t)NSEC_PER_SEC);
+    stats->timestamp.tv_nsec = (long)(time_ns % (int64_t)NSEC_PER_SEC);
+    stats->valid = valid;
+}
+
+/**
+ * Assemble one slot as net_stats_t for code that works row by row, such
+ * as the renderers; previous may be NULL
+ */
+void iface_soa_get(const iface_soa_t *soa, size_t id, net_stats_t *current,
+                   net_stats_t *previous) {
+    gather(soa, id, soa->current, soa->time_ns[id], soa->seen[id], current);
+    if (previous) {
+        gather(soa, id, soa->previous, soa->previous_ns[id], soa->has_previous[id], previous);
+    }
+}
+
+void iface_soa_free(iface_soa_t *soa) {
+    free(soa->pool);
+    free(soa->name);
+    free(soa->time_ns);
+    free(soa->previous_ns);
+    free(soa->elapsed);
+    free(soa->inverse);
+    free(soa->seen);
+    free(soa->has_previous);
+    free(soa->burst);
+    for (int c = 0; c < IFACE_COUNTERS; c++) {
+        free(soa->current[c]);
+        free(soa->previous[c]);
+        free(soa->delta[c]);
+        free(soa->rate[c]);
+    }
+    memset(soa, 0, sizeof(*soa));
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef IFACE_SOA_H
+#define IFACE_SOA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "netstat_monitor.h"
+#include "burst.h"
+
+/* Counter columns, in /proc/net/dev order */
+#define IFACE_COUNTERS 8
+
+enum {
+    IFACE_RX_BYTES,
+    IFACE_RX_PACKETS,
+    IFACE_RX_ERRORS,
+    IFACE_RX_DROPS,
+    IFACE_TX_BYTES,
+    IFACE_TX_PACKETS,
+    IFACE_TX_ERRORS,
+    IFACE_TX_DROPS,
+};
+
+/*
+ * Batch delta/rate kernel. inverse() turns each slot's sample times into
+ * elapsed seconds and 1 / elapsed, both 0 for slots without a rate;
+ * rates() then handles one counter column: delta = cur - prev with 32-bit
+ * wrap handling, rate = delta * inverse
+ * The scalar implementation is always available; SIMD variants give
+ * bit-identical results and are picked at runtime by iface_soa_kernel_get()
+ */
+typedef struct {
+    const char *name;
+    void (*inverse)(const int64_t *now, const int64_t *then, const uint8_t *seen,
+                    const uint8_t *has_previous, double *elapsed, double *inverse, size_t n);
+    void (*rates)(const uint64_t *cur, const uint64_t *prev, const double *inverse,
+                  uint64_t *delta, double *rate, size_t n);
+} iface_soa_kernel_t;
+
+extern const iface_soa_kernel_t iface_soa_kernel_scalar;
+
+const iface_soa_kernel_t *iface_soa_kernel_get(const char *name);
+
+/*
+ * Interface table as columns: one contiguous array per counter, indexed
+ * by a slot id that stays with an interface for as long as it exists,
+ * renames included. Names are interned in a string pool. Per-tick work
+ * (deltas, rates, moving current into previous) is a handful of straight
+ * loops over these arrays, with nothing but counters in the cache lines
+ * they touch
+ */
+typedef struct {
+    char *pool;
+    size_t pool_len;
+    size_t pool_capacity;
+    uint32_t *name;
+
+    uint64_t *current[IFACE_COUNTERS];
+    uint64_t *previous[IFACE_COUNTERS];
+    uint64_t *delta[IFACE_COUNTERS];
+    double *rate[IFACE_COUNTERS];
+    int64_t *time_ns;
+    int64_t *previous_ns;
+    double *elapsed;
+    /* 1 / elapsed, or 0 for slots without a rate, shared by all columns */
+    double *inverse;
+    /* 1 if current is from the latest sample */
+    uint8_t *seen;
+    /* 1 if previous is the slot's sample before current */
+    uint8_t *has_previous;
+    burst_stats_t *burst;
+
+    size_t count;
+    size_t capacity;
+    const iface_soa_kernel_t *kernel;
+} iface_soa_t;
+
+bool iface_soa_add(iface_soa_t *soa, const char *name, size_t len);
+bool iface_soa_rename(iface_soa_t *soa, size_t id, const char *name, size_t len);
+void iface_soa_restart(iface_soa_t *soa, size_t id);
+void iface_soa_compute(iface_soa_t *soa);
+void iface_soa_advance(iface_soa_t *soa);
+void iface_soa_get(const iface_soa_t *soa, size_t id, net_stats_t *current,
+                   net_stats_t *previous);
+void iface_soa_free(iface_soa_t *soa);
+
+static inline const char *iface_soa_name(const iface_soa_t *soa, size_t id) {
+    return soa->pool + soa->name[id];
+}
+
+#endif /* IFACE_SOA_H */
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <string.h>
+#include <stdint.h>
+
+#include "iface_soa.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define IFACE_SOA_HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+#ifdef IFACE_SOA_HAVE_X86
+
+/**
+ * Convert four unsigned 64-bit integers to double with the rounding of a
+ * plain C cast. AVX2 has no such instruction, so each half is placed in
+ * the mantissa of a double with a known exponent: the high half becomes
+ * 2^84 + hi * 2^32, the low half 2^52 + lo. Subtracting both offsets from
+ * the high part is exact, leaving a single rounding in the final add
+ */
+__attribute__((target("avx2")))
+static inline __m256d avx2_u64_to_double(__m256i v) {
+    const __m256i exp52 = _mm256_set1_epi64x(0x4330000000000000);
+    const __m256i exp84 = _mm256_set1_epi64x(0x4530000000000000);
+    const __m256d offsets = _mm256_set1_pd(0x1.00000001p84);
+
+    __m256i lo = _mm256_blend_epi32(v, exp52, 0xaa);
+    __m256i hi = _mm256_or_si256(_mm256_srli_epi64(v, 32), exp84);
+    __m256d high = _mm256_sub_pd(_mm256_castsi256_pd(hi), offsets);
+    return _mm256_add_pd(high, _mm256_castsi256_pd(lo));
+}
+
+/**
+ * Four slots per iteration. Lanes without a rate divide by whatever they
+ * hold and are masked to 0 afterwards; positive lanes convert exactly as
+ * unsigned, the same value the scalar (double) cast gives
+ */
+__attribute__((target("avx2")))
+static void avx2_inverse(const int64_t *restrict now, const int64_t *restrict then,
+                         const uint8_t *restrict seen, const uint8_t *restrict has_previous,
+                         double *restrict elapsed, double *restrict inverse, size_t n) {
+    const __m256d nsec = _mm256_set1_pd(1e-9);
+    const __m256d per_sec = _mm256_set1_pd(1e9);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m256i ns = _mm256_sub_epi64(_mm256_loadu_si256((const __m256i *)(now + i)),
+                                      _mm256_loadu_si256((const __m256i *)(then + i)));
+        uint32_t s, h;
+        memcpy(&s, seen + i, sizeof(s));
+        memcpy(&h, has_previous + i, sizeof(h));
+        __m256i flags = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128((int)(s & h)));
+        __m256i valid = _mm256_andnot_si256(_mm256_cmpeq_epi64(flags, _mm256_setzero_si256()),
+                                            _mm256_cmpgt_epi64(ns, _mm256_setzero_si256()));
+        __m256d mask = _mm256_castsi256_pd(valid);
+        __m256d dt = avx2_u64_to_double(ns);
+        _mm256_storeu_pd(elapsed + i, _mm256_and_pd(mask, _mm256_mul_pd(dt, nsec)));
+        _mm256_storeu_pd(inverse + i, _mm256_and_pd(mask, _mm256_div_pd(per_sec, dt)));
+    }
+    iface_soa_kernel_scalar.inverse(now + i, then + i, seen + i, has_previous + i,
+                                    elapsed + i, inverse + i, n - i);
+}
+
+/**
+ * Four slots per iteration. AVX2 only compares signed 64-bit lanes, so
+ * both sides are offset by 2^63 to find the counters that wrapped
+ */
+__attribute__((target("avx2")))
+static void avx2_rates(const uint64_t *restrict cur, const uint64_t *restrict prev,
+                       const double *restrict inverse, uint64_t *restrict delta,
+                       double *restrict rate, size_t n) {
+    const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i wrap = _mm256_set1_epi64x(INT64_C(1) << 32);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m256i c = _mm256_loadu_si256((const __m256i *)(cur + i));
+        __m256i p = _mm256_loadu_si256((const __m256i *)(prev + i));
+        __m256i wrapped = _mm256_cmpgt_epi64(_mm256_xor_si256(p, sign),
+                                             _mm256_xor_si256(c, sign));
+        __m256i d = _mm256_add_epi64(_mm256_sub_epi64(c, p), _mm256_and_si256(wrapped, wrap));
+        _mm256_storeu_si256((__m256i *)(delta + i), d);
+        __m256d r = _mm256_mul_pd(avx2_u64_to_double(d), _mm256_loadu_pd(inverse + i));
+        _mm256_storeu_pd(rate + i, r);
+    }
+    iface_soa_kernel_scalar.rates(cur + i, prev + i, inverse + i, delta + i, rate + i, n - i);
+}
+
+static const iface_soa_kernel_t iface_soa_kernel_avx2 = {
+    .name = "avx2",
+    .inverse = avx2_inverse,
+    .rates = avx2_rates,
+};
+
+#endif /* IFACE_SOA_HAVE_X86 */
+
+/**
+ * Look up a delta/rate kernel by name ("scalar", "avx2")
+ * NULL or "auto" selects the fastest one the CPU supports
+ * Returns NULL if the name is unknown or the CPU lacks the instructions
+ */
+const iface_soa_kernel_t *iface_soa_kernel_get(const char *name) {
+    bool pick_best = !name || strcmp(name, "auto") == 0;
+
+#ifdef IFACE_SOA_HAVE_X86
+    __builtin_cpu_init();
+    if ((pick_best || strcmp(name, "avx2") == 0) && __builtin_cpu_supports("avx2")) {
+        return &iface_soa_kernel_avx2;
+    }
+#endif
+
+    if (pick_best || strcmp(name, "scalar") == 0) {
+        return &iface_soa_kernel_scalar;
+    }
+    return NULL;
+}
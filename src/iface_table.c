@@ -0,0 +1,524 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "iface_table.h"
+
+/**
+ * Hash a name eight bytes at a time, a multiply and a shift per word, so
+ * that rejecting an unwatched line costs about as much as one memcmp()
+ * Only the name's own bytes are read; it needs no terminator
+ */
+static inline uint32_t name_hash(const char *name, size_t len) {
+    const uint64_t k = UINT64_C(0x9e3779b97f4a7c15);
+    uint64_t hash = len * k;
+    uint64_t word;
+
+    for (; len >= 8; name += 8, len -= 8) {
+        memcpy(&word, name, 8);
+        hash = (hash ^ word) * k;
+        hash ^= hash >> 32;
+    }
+    if (len) {
+        word = 0;
+        for (size_t i = 0; i < len; i++) {
+            word |= (uint64_t)(uint8_t)name[i] << (8 * i);
+        }
+        hash = (hash ^ word) * k;
+        hash ^= hash >> 32;
+    }
+    return (uint32_t)hash;
+}
+
+static inline uint32_t ifindex_hash(int ifindex) {
+    return (uint32_t)ifindex * 2654435761u;
+}
+
+static void index_insert(iface_bucket_t *index, size_t mask, uint32_t hash, uint32_t value) {
+    size_t i = hash & mask;
+    while (index[i].slot) {
+        i = (i + 1) & mask;
+    }
+    index[i].hash = hash;
+    index[i].slot = value;
+}
+
+/**
+ * Delete a bucket, moving later buckets of the same cluster back so that
+ * lookups never need tombstones
+ */
+static void index_remove(iface_bucket_t *index, size_t mask, uint32_t hash, uint32_t value) {
+    size_t i = hash & mask;
+    while (index[i].slot != value) {
+        if (!index[i].slot) {
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+    for (size_t j = (i + 1) & mask; index[j].slot; j = (j + 1) & mask) {
+        size_t home = index[j].hash & mask;
+        /* Move j into the hole unless its home lies cyclically in (i, j] */
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            index[i] = index[j];
+            i = j;
+        }
+    }
+    index[i].slot = 0;
+}
+
+/**
+ * Make room in the indexes for count entries, slots and rejected names
+ * together, rebuilding them when they have to grow
+ */
+static bool index_reserve(iface_table_t *table, size_t count) {
+    if (table->by_name && count * 2 <= table->index_mask + 1) {
+        return true;
+    }
+    size_t capacity = table->index_mask ? table->index_mask + 1 : 16;
+    while (count * 2 > capacity) {
+        capacity *= 2;
+    }
+    iface_bucket_t *by_name = calloc(capacity, sizeof(*by_name));
+    iface_bucket_t *by_ifindex = calloc(capacity, sizeof(*by_ifindex));
+    if (!by_name || !by_ifindex) {
+        fprintf(stderr, "Error: Cannot grow interface index: %s\n", strerror(errno));
+        free(by_name);
+        free(by_ifindex);
+        return false;
+    }
+
+    for (size_t i = 0; i < table->count; i++) {
+        const iface_slot_t *slot = &table->slots[i];
+        if (!slot->spare) {
+            index_insert(by_name, capacity - 1, slot->hash, (uint32_t)i + 1);
+        }
+        if (slot->ifindex > 0) {
+            index_insert(by_ifindex, capacity - 1, ifindex_hash(slot->ifindex), (uint32_t)i + 1);
+        }
+    }
+    for (size_t i = 0; i < table->rejected_count; i++) {
+        /* Taken by a renamed link */
+        if (table->rejected[i].name[0] == '\0') {
+            continue;
+        }
+        index_insert(by_name, capacity - 1, table->rejected[i].hash,
+                     IFACE_BUCKET_REJECTED | ((uint32_t)i + 1));
+    }
+    free(table->by_name);
+    free(table->by_ifindex);
+    table->by_name = by_name;
+    table->by_ifindex = by_ifindex;
+    table->index_mask = capacity - 1;
+    return true;
+}
+
+/**
+ * Flag a change for the output thread; clear drops flags still pending
+ */
+static void mark(iface_table_t *table, iface_slot_t *slot, uint8_t set, uint8_t clear) {
+    bool pending = slot->changes != 0;
+    slot->changes = (uint8_t)((slot->changes & ~clear) | set);
+    if (!pending && slot->changes) {
+        table->changed++;
+    } else if (pending && !slot->changes) {
+        table->changed--;
+    }
+}
+
+static void set_name(iface_slot_t *slot, const char *name, size_t len, uint32_t hash) {
+    memset(slot->current.interface, 0, sizeof(slot->current.interface));
+    memcpy(slot->current.interface, name, len);
+    slot->hash = hash;
+}
+
+bool iface_table_add(iface_table_t *table, const char *name) {
+    return iface_table_add_n(table, name, strlen(name));
+}
+
+/**
+ * Append an interface to the table, growing it when full
+ * The name need not be NUL-terminated and is truncated to MAX_IFACE_LEN - 1
+ * Returns false on allocation failure
+ */
+bool iface_table_add_n(iface_table_t *table, const char *name, size_t len) {
+    if (!index_reserve(table, table->count + table->rejected_count + 1)) {
+        return false;
+    }
+    if (table->count == table->capacity) {
+        size_t new_capacity = table->capacity ? table->capacity * 2 : 8;
+        iface_slot_t *slots = realloc(table->slots, new_capacity * sizeof(*slots));
+        if (!slots) {
+            fprintf(stderr, "Error: Cannot grow interface table: %s\n", strerror(errno));
+            return false;
+        }
+        table->slots = slots;
+        table->capacity = new_capacity;
+    }
+
+    size_t id = table->count++;
+    iface_slot_t *slot = &table->slots[id];
+    memset(slot, 0, sizeof(*slot));
+    if (len >= sizeof(slot->current.interface)) {
+        len = sizeof(slot->current.interface) - 1;
+    }
+    memcpy(slot->current.interface, name, len);
+    slot->hash = name_hash(name, len);
+    index_insert(table->by_name, table->index_mask, slot->hash, (uint32_t)id + 1);
+    return true;
+}
+
+/**
+ * Remember a name the filter rejected, so that it is not matched again
+ */
+static void reject_n(iface_table_t *table, const char *name, size_t len, uint32_t hash) {
+    if (!index_reserve(table, table->count + table->rejected_count + 1)) {
+        return;
+    }
+    if (table->rejected_count == table->rejected_capacity) {
+        size_t capacity = table->rejected_capacity ? table->rejected_capacity * 2 : 16;
+        iface_rejected_t *rejected = realloc(table->rejected, capacity * sizeof(*rejected));
+        if (!rejected) {
+            return;
+        }
+        table->rejected = rejected;
+        table->rejected_capacity = capacity;
+    }
+    size_t id = table->rejected_count++;
+    iface_rejected_t *entry = &table->rejected[id];
+    memset(entry->name, 0, sizeof(entry->name));
+    memcpy(entry->name, name, len);
+    entry->hash = hash;
+    index_insert(table->by_name, table->index_mask, hash, IFACE_BUCKET_REJECTED | ((uint32_t)id + 1));
+}
+
+/**
+ * Whether the filter, if any, selects a name span for a slot of its own
+ */
+static bool selected(const iface_table_t *table, const char *name, size_t len) {
+    if (!table->filter) {
+        return true;
+    }
+    char copy[MAX_IFACE_LEN];
+    memcpy(copy, name, len);
+    copy[len] = '\0';
+    return iface_filter_match(table->filter, copy);
+}
+
+/**
+ * The name index bucket value for a name span, or 0 if it is unknown
+ */
+static uint32_t name_lookup(const iface_table_t *table, const char *name, size_t len,
+                            uint32_t hash) {
+    size_t mask = table->index_mask;
+    for (size_t i = hash & mask; table->by_name[i].slot; i = (i + 1) & mask) {
+        uint32_t value = table->by_name[i].slot;
+        if (table->by_name[i].hash != hash) {
+            continue;
+        }
+        const char *known = value & IFACE_BUCKET_REJECTED
+                                ? table->rejected[(value & ~IFACE_BUCKET_REJECTED) - 1].name
+                                : table->slots[value - 1].current.interface;
+        if (known[len] == '\0' && memcmp(known, name, len) == 0) {
+            return value;
+        }
+    }
+    return 0;
+}
+
+iface_slot_t *iface_table_find(iface_table_t *table, const char *name) {
+    return iface_table_find_n(table, name, strlen(name));
+}
+
+/**
+ * Look up a slot by a name that is not NUL-terminated, such as a span
+ * pointing into the /proc/net/dev read buffer. An unwatched name usually
+ * stops at the first empty bucket; names are only compared on a full
+ * hash match
+ */
+iface_slot_t *iface_table_find_n(iface_table_t *table, const char *name, size_t len) {
+    if (len >= MAX_IFACE_LEN || !table->by_name) {
+        return NULL;
+    }
+    uint32_t value = name_lookup(table, name, len, name_hash(name, len));
+    if (!value || (value & IFACE_BUCKET_REJECTED)) {
+        return NULL;
+    }
+    return &table->slots[value - 1];
+}
+
+/**
+ * Look up the slot for a name found by a collector. In watch-all mode a
+ * name seen for the first time is run through the filter once: it gets a
+ * slot if selected, and is remembered as rejected otherwise
+ * Returns NULL for names that are not watched
+ */
+iface_slot_t *iface_table_discover(iface_table_t *table, const char *name, size_t len) {
+    if (len >= MAX_IFACE_LEN) {
+        return NULL;
+    }
+    uint32_t hash = name_hash(name, len);
+    uint32_t value = table->by_name ? name_lookup(table, name, len, hash) : 0;
+    if (value) {
+        if (value & IFACE_BUCKET_REJECTED) {
+            return NULL;
+        }
+        iface_slot_t *slot = &table->slots[value - 1];
+        if (slot->removed) {
+            /* Back under the same name: a new link, so a new baseline */
+            slot->removed = false;
+            mark(table, slot, IFACE_CHANGE_RESTARTED, IFACE_CHANGE_REMOVED);
+        }
+        return slot;
+    }
+    if (!table->watch_all) {
+        return NULL;
+    }
+
+    if (!selected(table, name, len)) {
+        reject_n(table, name, len, hash);
+        return NULL;
+    }
+
+    /* The id of a deleted link is handed out again, with a new name and baseline */
+    if (table->spare_count) {
+        size_t id = table->spare[--table->spare_count];
+        iface_slot_t *slot = &table->slots[id];
+        slot->spare = false;
+        slot->removed = false;
+        slot->seen = false;
+        memset(&slot->current, 0, sizeof(slot->current));
+        set_name(slot, name, len, hash);
+        index_insert(table->by_name, table->index_mask, hash, (uint32_t)id + 1);
+        mark(table, slot, IFACE_CHANGE_RENAMED | IFACE_CHANGE_RESTARTED,
+             IFACE_CHANGE_REMOVED | IFACE_CHANGE_DESELECTED);
+        return slot;
+    }
+    if (!iface_table_add_n(table, name, len)) {
+        return NULL;
+    }
+    iface_slot_t *slot = &table->slots[table->count - 1];
+    slot->discovered = true;
+    return slot;
+}
+
+/**
+ * Look up a slot by kernel ifindex, as reported by rtnetlink
+ */
+iface_slot_t *iface_table_find_ifindex(iface_table_t *table, int ifindex) {
+    if (ifindex <= 0 || !table->by_ifindex) {
+        return NULL;
+    }
+    uint32_t hash = ifindex_hash(ifindex);
+    size_t mask = table->index_mask;
+    for (size_t i = hash & mask; table->by_ifindex[i].slot; i = (i + 1) & mask) {
+        iface_slot_t *slot = &table->slots[table->by_ifindex[i].slot - 1];
+        if (slot->ifindex == ifindex) {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Record the ifindex a slot's interface currently has, moving it in the
+ * index. A slot that held the ifindex before loses it, since the kernel
+ * gives each index to one link at a time
+ */
+void iface_table_set_ifindex(iface_table_t *table, iface_slot_t *slot, int ifindex) {
+    if (slot->ifindex == ifindex) {
+        return;
+    }
+    size_t id = (size_t)(slot - table->slots);
+    size_t mask = table->index_mask;
+
+    iface_slot_t *owner = iface_table_find_ifindex(table, ifindex);
+    if (owner) {
+        index_remove(table->by_ifindex, mask, ifindex_hash(ifindex),
+                     (uint32_t)(owner - table->slots) + 1);
+        owner->ifindex = 0;
+    }
+    if (slot->ifindex > 0) {
+        index_remove(table->by_ifindex, mask, ifindex_hash(slot->ifindex), (uint32_t)id + 1);
+    }
+    slot->ifindex = ifindex > 0 ? ifindex : 0;
+    if (slot->ifindex) {
+        index_insert(table->by_ifindex, mask, ifindex_hash(ifindex), (uint32_t)id + 1);
+    }
+}
+
+/**
+ * Drop a removed slot from the name index and queue its id for reuse
+ */
+static void retire(iface_table_t *table, iface_slot_t *slot) {
+    if (table->spare_count == table->spare_capacity) {
+        size_t capacity = table->spare_capacity ? table->spare_capacity * 2 : 16;
+        size_t *spare = realloc(table->spare, capacity * sizeof(*spare));
+        if (!spare) {
+            return;
+        }
+        table->spare = spare;
+        table->spare_capacity = capacity;
+    }
+    size_t id = (size_t)(slot - table->slots);
+    index_remove(table->by_name, table->index_mask, slot->hash, (uint32_t)id + 1);
+    table->spare[table->spare_count++] = id;
+    slot->spare = true;
+}
+
+/**
+ * Take a deleted link out of the ifindex index. A slot named on the
+ * command line keeps its name, waiting for the link to come back; a
+ * discovered one becomes spare for the next new interface
+ */
+void iface_table_remove(iface_table_t *table, iface_slot_t *slot) {
+    if (slot->spare) {
+        return;
+    }
+    iface_table_set_ifindex(table, slot, 0);
+    slot->seen = false;
+    if (!slot->removed) {
+        slot->removed = true;
+        mark(table, slot, IFACE_CHANGE_REMOVED, IFACE_CHANGE_RESTARTED);
+    }
+    if (slot->discovered) {
+        retire(table, slot);
+    }
+}
+
+/**
+ * Give a slot the new name of its link, keeping its id and so its counter
+ * history. A discovered slot or rejected entry still holding that name is
+ * stale, since the kernel gives each name to one link at a time, and
+ * loses it. A slot named on the command line keeps the name and takes
+ * the link over with a new baseline; the renamed slot is removed
+ * A discovered slot whose new name the filter turns down is removed and
+ * flagged renamed as well, and the name is remembered as rejected
+ * Returns the slot now following the link, or NULL if none does
+ */
+iface_slot_t *iface_table_rename(iface_table_t *table, iface_slot_t *slot, const char *name,
+                                 size_t len) {
+    if (len >= MAX_IFACE_LEN || slot->spare) {
+        return NULL;
+    }
+    uint32_t id = (uint32_t)(slot - table->slots) + 1;
+    uint32_t hash = name_hash(name, len);
+    uint32_t value = name_lookup(table, name, len, hash);
+    if (value == id) {
+        return slot;
+    }
+    if (value & IFACE_BUCKET_REJECTED) {
+        index_remove(table->by_name, table->index_mask, hash, value);
+        table->rejected[(value & ~IFACE_BUCKET_REJECTED) - 1].name[0] = '\0';
+    } else if (value) {
+        iface_slot_t *owner = &table->slots[value - 1];
+        if (!owner->discovered) {
+            int ifindex = slot->ifindex;
+            iface_table_remove(table, slot);
+            owner->removed = false;
+            iface_table_set_ifindex(table, owner, ifindex);
+            mark(table, owner, IFACE_CHANGE_RESTARTED, IFACE_CHANGE_REMOVED);
+            return owner;
+        }
+        iface_table_remove(table, owner);
+    }
+
+    if (slot->discovered && !selected(table, name, len)) {
+        /* Renamed out of the selection: gone under its new name */
+        iface_table_remove(table, slot);
+        set_name(slot, name, len, hash);
+        mark(table, slot, IFACE_CHANGE_RENAMED | IFACE_CHANGE_DESELECTED, 0);
+        reject_n(table, name, len, hash);
+        return NULL;
+    }
+    index_remove(table->by_name, table->index_mask, slot->hash, id);
+    set_name(slot, name, len, hash);
+    index_insert(table->by_name, table->index_mask, hash, id);
+    mark(table, slot, IFACE_CHANGE_RENAMED, 0);
+    return slot;
+}
+
+/**
+ * Start a new baseline for a slot whose name now belongs to another link
+ */
+void iface_table_restart(iface_table_t *table, iface_slot_t *slot) {
+    mark(table, slot, IFACE_CHANGE_RESTARTED, 0);
+}
+
+/**
+ * Forget the changes once the output thread has been told about them
+ */
+void iface_table_clear_changes(iface_table_t *table) {
+    for (size_t i = 0; i < table->count && table->changed; i++) {
+        if (table->slots[i].changes) {
+            table->slots[i].changes = 0;
+            table->changed--;
+        }
+    }
+}
+
+/**
+ * Mark every slot unseen before a new sample is collected
+ */
+void iface_table_begin_sample(iface_table_t *table) {
+    for (size_t i = 0; i < table->count; i++) {
+        table->slots[i].seen = false;
+    }
+}
+
+/**
+ * Give every slot filled by the sample just collected the same timestamp
+ */
+void iface_table_stamp(iface_table_t *table) {
+    struct timespec now;
+    if (clock_gettime(CLOCK_MONOTONIC, &now) != 0) {
+        fprintf(stderr, "Warning: clock_gettime failed: %s\n", strerror(errno));
+        now.tv_sec = 0;
+        now.tv_nsec = 0;
+    }
+
+    for (size_t i = 0; i < table->count; i++) {
+        if (table->slots[i].seen) {
+            table->slots[i].current.timestamp = now;
+        }
+    }
+}
+
+void iface_table_free(iface_table_t *table) {
+    free(table->slots);
+    free(table->by_name);
+    free(table->by_ifindex);
+    free(table->rejected);
+    free(table->spare);
+    table->slots = NULL;
+    table->spare = NULL;
+    table->spare_count = 0;
+    table->spare_capacity = 0;
+    table->changed = 0;
+    table->rejected = NULL;
+    table->rejected_count = 0;
+    table->rejected_capacity = 0;
+    table->by_name = NULL;
+    table->by_ifindex = NULL;
+    table->index_mask = 0;
+    table->count = 0;
+    table->capacity = 0;
+}
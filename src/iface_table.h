@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef IFACE_TABLE_H
+#define IFACE_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "netstat_monitor.h"
+#include "iface_filter.h"
+
+/* Fixed-size copies of an "all" table leave room for at least this many */
+#define IFACE_TABLE_RESERVE 64
+
+/* Slot changes the output thread has not been told about yet */
+enum {
+    IFACE_CHANGE_RENAMED = 1,
+    IFACE_CHANGE_RESTARTED = 2,
+    IFACE_CHANGE_REMOVED = 4,
+    /* Removed because the filter does not select its new name */
+    IFACE_CHANGE_DESELECTED = 8,
+};
+
+/*
+ * The collectors' side of the table: just the latest counters. Deltas,
+ * rates and burst statistics live in the output thread's iface_soa_t
+ */
+typedef struct {
+    net_stats_t current;
+    /* Hash of the name, kept for rebuilding the index */
+    uint32_t hash;
+    /* Kernel ifindex, or 0 until a collector reports it */
+    int ifindex;
+    bool seen;
+    /* IFACE_CHANGE_* flags */
+    uint8_t changes;
+    /* Added by discovery rather than named on the command line */
+    bool discovered;
+    /* The link was deleted */
+    bool removed;
+    /* Removed and out of the name index; the id awaits reuse */
+    bool spare;
+    /* Reported by the link event socket's dump in progress */
+    bool listed;
+} iface_slot_t;
+
+/*
+ * One bucket of an open-addressing index: slot id + 1, 0 if empty
+ * In the name index, IFACE_BUCKET_REJECTED marks a name the filter turned
+ * down instead, indexing the rejected list
+ */
+typedef struct {
+    uint32_t hash;
+    uint32_t slot;
+} iface_bucket_t;
+
+#define IFACE_BUCKET_REJECTED (UINT32_C(1) << 31)
+
+typedef struct {
+    char name[MAX_IFACE_LEN];
+    uint32_t hash;
+} iface_rejected_t;
+
+/*
+ * Slots are never reordered, so their ids are stable. Two linear-probing
+ * indexes map names and ifindexes to ids; both are kept at most half full
+ * and updated as slots are added or change ifindex, so that a line for an
+ * unwatched interface costs one hash of its name and usually one probe
+ * In watch-all mode a filter decides which new names get a slot; names it
+ * rejects are remembered in the name index, so each is matched only once
+ * A renamed link keeps its slot. A discovered slot whose link is deleted
+ * becomes spare, and the next new interface reuses its id. Every such
+ * change is flagged on the slot and counted in changed until the sampler
+ * passes it on
+ */
+typedef struct {
+    iface_slot_t *slots;
+    size_t count;
+    size_t capacity;
+    bool watch_all;
+    iface_bucket_t *by_name;
+    iface_bucket_t *by_ifindex;
+    size_t index_mask;
+    const iface_filter_t *filter;
+    iface_rejected_t *rejected;
+    size_t rejected_count;
+    size_t rejected_capacity;
+    size_t *spare;
+    size_t spare_count;
+    size_t spare_capacity;
+    size_t changed;
+} iface_table_t;
+
+bool iface_table_add(iface_table_t *table, const char *name);
+bool iface_table_add_n(iface_table_t *table, const char *name, size_t len);
+iface_slot_t *iface_table_find(iface_table_t *table, const char *name);
+iface_slot_t *iface_table_find_n(iface_table_t *table, const char *name, size_t len);
+iface_slot_t *iface_table_discover(iface_table_t *table, const char *name, size_t len);
+iface_slot_t *iface_table_find_ifindex(iface_table_t *table, int ifindex);
+void iface_table_set_ifindex(iface_table_t *table, iface_slot_t *slot, int ifindex);
+iface_slot_t *iface_table_rename(iface_table_t *table, iface_slot_t *slot, const char *name,
+                                 size_t len);
+void iface_table_remove(iface_table_t *table, iface_slot_t *slot);
+void iface_table_restart(iface_table_t *table, iface_slot_t *slot);
+void iface_table_clear_changes(iface_table_t *table);
+void iface_table_begin_sample(iface_table_t *table);
+void iface_table_stamp(iface_table_t *table);
+void iface_table_free(iface_table_t *table);
+
+#endif /* IFACE_TABLE_H */
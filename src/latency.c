@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "latency.h"
+
+/* Exact below 4 ns, then the top two bits after the leading one pick the sub-bucket */
+static unsigned latency_bucket(uint64_t ns) {
+    if (ns < (UINT64_C(1) << LATENCY_SUB_BITS)) {
+        return (unsigned)ns;
+    }
+    unsigned msb = 63u - (unsigned)__builtin_clzll(ns);
+    unsigned sub = (unsigned)(ns >> (msb - LATENCY_SUB_BITS)) & ((1u << LATENCY_SUB_BITS) - 1);
+    return (msb << LATENCY_SUB_BITS) | sub;
+}
+
+/* Largest latency that falls into a bucket */
+static uint64_t latency_bucket_limit(unsigned bucket) {
+    unsigned msb = bucket >> LATENCY_SUB_BITS;
+    if (msb < LATENCY_SUB_BITS) {
+        return bucket;
+    }
+    uint64_t sub = bucket & ((1u << LATENCY_SUB_BITS) - 1);
+    return (((UINT64_C(1) << LATENCY_SUB_BITS) + sub + 1) << (msb - LATENCY_SUB_BITS)) - 1;
+}
+
+void latency_record(latency_stats_t *latency, uint64_t ns) {
+    if (latency->samples == 0 || ns < latency->min_ns) {
+        latency->min_ns = ns;
+    }
+    if (ns > latency->max_ns) {
+        latency->max_ns = ns;
+    }
+    latency->total_ns += ns;
+    latency->samples++;
+    latency->histogram[latency_bucket(ns)]++;
+}
+
+/**
+ * Upper bound of the bucket holding the given percentile (0-100),
+ * clamped to the largest latency actually seen
+ */
+uint64_t latency_percentile(const latency_stats_t *latency, double percentile) {
+    if (latency->samples == 0) {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t)((double)latency->samples * percentile / 100.0 + 0.999999);
+    uint64_t seen = 0;
+    for (unsigned b = 0; b < LATENCY_BUCKETS; b++) {
+        seen += latency->histogram[b];
+        if (seen >= rank) {
+            uint64_t limit = latency_bucket_limit(b);
+            return limit < latency->max_ns ? limit : latency->max_ns;
+        }
+    }
+    return latency->max_ns;
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+
+/* Log-linear histogram: four sub-buckets per power of two nanoseconds */
+#define LATENCY_SUB_BITS 2
+#define LATENCY_BUCKETS (64 << LATENCY_SUB_BITS)
+
+typedef struct {
+    uint64_t samples;
+    uint64_t total_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t histogram[LATENCY_BUCKETS];
+} latency_stats_t;
+
+void latency_record(latency_stats_t *latency, uint64_t ns);
+uint64_t latency_percentile(const latency_stats_t *latency, double percentile);
+
+#endif /* LATENCY_H */
@@ -0,0 +1,413 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_link.h>
+
+#include "netlink.h"
+
+/* Large enough for a full page of RTM_NEWLINK messages from a dump */
+#define NETLINK_BUF_SIZE 32768
+/* Dumps sent per sample while the kernel keeps flagging them interrupted */
+#define NETLINK_DUMP_ATTEMPTS 4
+
+/**
+ * Open an rtnetlink socket for link dumps
+ */
+bool netlink_open(netlink_reader_t *reader) {
+    reader->seq = 0;
+    reader->io = (io_counters_t){0};
+    reader->bufsize = NETLINK_BUF_SIZE;
+    reader->buf = malloc(reader->bufsize);
+    if (!reader->buf) {
+        fprintf(stderr, "Error: Cannot allocate netlink buffer: %s\n", strerror(errno));
+        reader->fd = -1;
+        return false;
+    }
+
+    reader->fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (reader->fd < 0) {
+        fprintf(stderr, "Error: Cannot open rtnetlink socket: %s\n", strerror(errno));
+        netlink_close(reader);
+        return false;
+    }
+    return true;
+}
+
+void netlink_close(netlink_reader_t *reader) {
+    if (reader->fd >= 0) {
+        close(reader->fd);
+        reader->fd = -1;
+    }
+    free(reader->buf);
+    reader->buf = NULL;
+    reader->bufsize = 0;
+}
+
+/**
+ * Copy the counters of one RTM_NEWLINK message into its table slot
+ * Drops are reported the way /proc/net/dev does: dropped plus missed
+ */
+static void netlink_parse_link(const struct nlmsghdr *nh, iface_table_t *table) {
+    const struct ifinfomsg *ifm = NLMSG_DATA(nh);
+    int len = (int)IFLA_PAYLOAD(nh);
+    const char *name = NULL;
+    const struct rtattr *stats_attr = NULL;
+
+    for (const struct rtattr *rta = IFLA_RTA(ifm); RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+        if (rta->rta_type == IFLA_IFNAME) {
+            name = RTA_DATA(rta);
+        } else if (rta->rta_type == IFLA_STATS64) {
+            stats_attr = rta;
+        }
+    }
+    if (!name || !stats_attr) {
+        return;
+    }
+
+    /* Known links are found by ifindex; the name is only hashed for new ones */
+    size_t name_len = strnlen(name, MAX_IFACE_LEN);
+    if (name_len >= MAX_IFACE_LEN) {
+        return;
+    }
+    iface_slot_t *slot = iface_table_find_ifindex(table, ifm->ifi_index);
+    if (slot && (slot->current.interface[name_len] != '\0' ||
+                 memcmp(slot->current.interface, name, name_len) != 0)) {
+        slot = NULL;
+    }
+    if (!slot) {
+        slot = iface_table_discover(table, name, name_len);
+        if (!slot) {
+            return;
+        }
+        iface_table_set_ifindex(table, slot, ifm->ifi_index);
+    }
+
+    /* The attribute is only 4-byte aligned and may be shorter than our headers' struct */
+    struct rtnl_link_stats64 stats64;
+    size_t payload = RTA_PAYLOAD(stats_attr);
+    memset(&stats64, 0, sizeof(stats64));
+    memcpy(&stats64, RTA_DATA(stats_attr), payload < sizeof(stats64) ? payload : sizeof(stats64));
+
+    net_stats_t *stats = &slot->current;
+    stats->rx_bytes = stats64.rx_bytes;
+    stats->rx_packets = stats64.rx_packets;
+    stats->rx_errors = stats64.rx_errors;
+    stats->rx_drops = stats64.rx_dropped + stats64.rx_missed_errors;
+    stats->tx_bytes = stats64.tx_bytes;
+    stats->tx_packets = stats64.tx_packets;
+    stats->tx_errors = stats64.tx_errors;
+    stats->tx_drops = stats64.tx_dropped;
+    stats->valid = true;
+    slot->seen = true;
+}
+
+/**
+ * Send one RTM_GETLINK dump request and apply every link it returns
+ * Sets *interrupted if the kernel flagged the dump as inconsistent
+ * because the link list changed while it ran
+ * Returns false on socket or protocol errors
+ */
+static bool netlink_dump_stats(netlink_reader_t *reader, iface_table_t *table,
+                               bool *interrupted) {
+    struct {
+        struct nlmsghdr nh;
+        struct ifinfomsg ifm;
+    } req;
+
+    memset(&req, 0, sizeof(req));
+    req.nh.nlmsg_len = NLMSG_LENGTH(sizeof(req.ifm));
+    req.nh.nlmsg_type = RTM_GETLINK;
+    req.nh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    req.nh.nlmsg_seq = ++reader->seq;
+    req.ifm.ifi_family = AF_UNSPEC;
+
+    reader->io.syscalls++;
+    if (send(reader->fd, &req, req.nh.nlmsg_len, 0) < 0) {
+        fprintf(stderr, "Error: Cannot send RTM_GETLINK: %s\n", strerror(errno));
+        return false;
+    }
+
+    iface_table_begin_sample(table);
+    *interrupted = false;
+
+    bool done = false;
+    while (!done) {
+        /* MSG_TRUNC makes recv() report the datagram's full length */
+        ssize_t n = recv(reader->fd, reader->buf, reader->bufsize, MSG_TRUNC);
+        reader->io.syscalls++;
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "Error: Cannot receive link dump: %s\n", strerror(errno));
+            return false;
+        }
+        if ((size_t)n > reader->bufsize) {
+            fprintf(stderr, "Error: Link dump message of %zd bytes truncated to %zu\n", n,
+                    reader->bufsize);
+            return false;
+        }
+
+        reader->io.bytes += (uint64_t)n;
+        int len = (int)n;
+        for (const struct nlmsghdr *nh = (const struct nlmsghdr *)(const void *)reader->buf;
+             NLMSG_OK(nh, len); nh = NLMSG_NEXT(nh, len)) {
+            if (nh->nlmsg_seq != reader->seq) {
+                continue;
+            }
+            if (nh->nlmsg_flags & NLM_F_DUMP_INTR) {
+                *interrupted = true;
+            }
+            if (nh->nlmsg_type == NLMSG_DONE) {
+                done = true;
+                break;
+            }
+            if (nh->nlmsg_type == NLMSG_ERROR) {
+                const struct nlmsgerr *err = NLMSG_DATA(nh);
+                fprintf(stderr, "Error: RTM_GETLINK failed: %s\n", strerror(-err->error));
+                return false;
+            }
+            if (nh->nlmsg_type == RTM_NEWLINK) {
+                netlink_parse_link(nh, table);
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Dump rtnl_link_stats64 for every link with one RTM_GETLINK request
+ * In watch-all mode, links seen for the first time are appended
+ * A dump the kernel flags as interrupted may have missed or repeated
+ * links, so it is discarded and sent again
+ * Returns true on success, false on socket or protocol errors or if the
+ * dump stays interrupted
+ */
+bool netlink_read_stats(netlink_reader_t *reader, iface_table_t *table) {
+    for (int attempt = 0; attempt < NETLINK_DUMP_ATTEMPTS; attempt++) {
+        bool interrupted;
+        if (!netlink_dump_stats(reader, table, &interrupted)) {
+            return false;
+        }
+        if (!interrupted) {
+            iface_table_stamp(table);
+            return true;
+        }
+    }
+    fprintf(stderr, "Error: Link dump interrupted %d times in a row\n", NETLINK_DUMP_ATTEMPTS);
+    iface_table_begin_sample(table);
+    return false;
+}
+
+/* Link events */
+
+static bool netlink_events_dump(netlink_events_t *events) {
+    struct {
+        struct nlmsghdr nh;
+        struct ifinfomsg ifm;
+    } req;
+
+    memset(&req, 0, sizeof(req));
+    req.nh.nlmsg_len = NLMSG_LENGTH(sizeof(req.ifm));
+    req.nh.nlmsg_type = RTM_GETLINK;
+    req.nh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    req.nh.nlmsg_seq = ++events->seq;
+    req.ifm.ifi_family = AF_UNSPEC;
+
+    if (send(events->fd, &req, req.nh.nlmsg_len, 0) < 0) {
+        return false;
+    }
+    events->dumping = true;
+    events->resync = false;
+    return true;
+}
+
+/**
+ * Open the link event socket and ask for a dump of the current links
+ */
+bool netlink_events_open(netlink_events_t *events) {
+    memset(events, 0, sizeof(*events));
+    events->bufsize = NETLINK_BUF_SIZE;
+    events->buf = malloc(events->bufsize);
+    if (!events->buf) {
+        fprintf(stderr, "Error: Cannot allocate netlink buffer: %s\n", strerror(errno));
+        events->fd = -1;
+        return false;
+    }
+
+    events->fd = socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (events->fd < 0) {
+        fprintf(stderr, "Error: Cannot open rtnetlink socket: %s\n", strerror(errno));
+        netlink_events_close(events);
+        return false;
+    }
+    struct sockaddr_nl addr = {.nl_family = AF_NETLINK, .nl_groups = RTMGRP_LINK};
+    if (bind(events->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        fprintf(stderr, "Error: Cannot join the rtnetlink link group: %s\n", strerror(errno));
+        netlink_events_close(events);
+        return false;
+    }
+    if (!netlink_events_dump(events)) {
+        fprintf(stderr, "Error: Cannot send RTM_GETLINK: %s\n", strerror(errno));
+        netlink_events_close(events);
+        return false;
+    }
+    return true;
+}
+
+void netlink_events_close(netlink_events_t *events) {
+    if (events->fd >= 0) {
+        close(events->fd);
+        events->fd = -1;
+    }
+    free(events->buf);
+    events->buf = NULL;
+    events->bufsize = 0;
+}
+
+/**
+ * Apply one RTM_NEWLINK or RTM_DELLINK to the table. A known ifindex
+ * under a new name is a rename; a known name under a new ifindex is a
+ * link that was deleted and created again
+ * Returns the slot of a link that exists, or NULL
+ */
+static iface_slot_t *netlink_events_link(const struct nlmsghdr *nh, iface_table_t *table) {
+    const struct ifinfomsg *ifm = NLMSG_DATA(nh);
+    if (nh->nlmsg_len < NLMSG_LENGTH(sizeof(*ifm)) || ifm->ifi_family == AF_BRIDGE) {
+        /* AF_BRIDGE messages are about bridge ports, not the links themselves */
+        return NULL;
+    }
+
+    iface_slot_t *slot = iface_table_find_ifindex(table, ifm->ifi_index);
+    if (nh->nlmsg_type == RTM_DELLINK) {
+        if (slot) {
+            iface_table_remove(table, slot);
+        }
+        return NULL;
+    }
+
+    const char *name = NULL;
+    int len = (int)IFLA_PAYLOAD(nh);
+    for (const struct rtattr *rta = IFLA_RTA(ifm); RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+        if (rta->rta_type == IFLA_IFNAME) {
+            name = RTA_DATA(rta);
+            break;
+        }
+    }
+    if (!name) {
+        return NULL;
+    }
+
+    size_t name_len = strnlen(name, MAX_IFACE_LEN);
+    if (name_len >= MAX_IFACE_LEN) {
+        return NULL;
+    }
+    if (slot) {
+        if (slot->current.interface[name_len] != '\0' ||
+            memcmp(slot->current.interface, name, name_len) != 0) {
+            return iface_table_rename(table, slot, name, name_len);
+        }
+        return slot;
+    }
+    slot = iface_table_discover(table, name, name_len);
+    if (!slot) {
+        return NULL;
+    }
+    if (slot->ifindex > 0) {
+        iface_table_restart(table, slot);
+    }
+    iface_table_set_ifindex(table, slot, ifm->ifi_index);
+    return slot;
+}
+
+/**
+ * Finish a link dump. A complete one removes the slots of links it did
+ * not list; one the kernel interrupted is sent again
+ */
+static void netlink_events_dump_done(netlink_events_t *events, iface_table_t *table,
+                                     bool complete) {
+    events->dumping = false;
+    for (size_t i = 0; i < table->count; i++) {
+        iface_slot_t *slot = &table->slots[i];
+        if (complete && !events->interrupted && !events->resync &&
+            !slot->listed && !slot->removed && !slot->spare) {
+            iface_table_remove(table, slot);
+        }
+        slot->listed = false;
+    }
+    if (events->interrupted) {
+        events->interrupted = false;
+        events->resync = true;
+    }
+}
+
+/**
+ * Apply every queued link event without blocking. When the kernel had to
+ * drop events, a new dump brings the table up to date
+ */
+void netlink_events_process(netlink_events_t *events, iface_table_t *table) {
+    for (;;) {
+        ssize_t n = recv(events->fd, events->buf, events->bufsize, 0);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == ENOBUFS) {
+                /* Parts of a dump in progress may be lost too */
+                if (events->dumping) {
+                    netlink_events_dump_done(events, table, false);
+                }
+                events->resync = true;
+                continue;
+            }
+            break;
+        }
+
+        int len = (int)n;
+        for (const struct nlmsghdr *nh = (const struct nlmsghdr *)(const void *)events->buf;
+             NLMSG_OK(nh, len); nh = NLMSG_NEXT(nh, len)) {
+            bool ours = events->dumping && nh->nlmsg_seq == events->seq;
+            if (ours && (nh->nlmsg_flags & NLM_F_DUMP_INTR)) {
+                events->interrupted = true;
+            }
+            if (nh->nlmsg_type == NLMSG_DONE || nh->nlmsg_type == NLMSG_ERROR) {
+                if (ours) {
+                    netlink_events_dump_done(events, table, nh->nlmsg_type == NLMSG_DONE);
+                }
+            } else if (nh->nlmsg_type == RTM_NEWLINK || nh->nlmsg_type == RTM_DELLINK) {
+                iface_slot_t *slot = netlink_events_link(nh, table);
+                /* Links announced while the dump runs exist too, even if it missed them */
+                if (slot && (ours || (events->dumping && nh->nlmsg_seq == 0))) {
+                    slot->listed = true;
+                }
+            }
+        }
+    }
+
+    if (events->resync && !events->dumping) {
+        netlink_events_dump(events);
+    }
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef NETLINK_H
+#define NETLINK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "netstat_monitor.h"
+#include "iface_table.h"
+
+typedef struct {
+    int fd;
+    uint32_t seq;
+    char *buf;
+    size_t bufsize;
+    io_counters_t io;
+} netlink_reader_t;
+
+/*
+ * A nonblocking rtnetlink socket in the RTNLGRP_LINK group. Link events
+ * rename, remove and restart table slots as they arrive; a link dump,
+ * sent on open and again after the kernel dropped events, fills in
+ * ifindexes and catches up on anything missed. Slots whose link the
+ * dump did not list are removed; a dump the kernel flags as interrupted
+ * is sent again instead
+ */
+typedef struct {
+    int fd;
+    uint32_t seq;
+    char *buf;
+    size_t bufsize;
+    bool dumping;
+    bool resync;
+    bool interrupted;
+} netlink_events_t;
+
+bool netlink_open(netlink_reader_t *reader);
+void netlink_close(netlink_reader_t *reader);
+bool netlink_read_stats(netlink_reader_t *reader, iface_table_t *table);
+
+bool netlink_events_open(netlink_events_t *events);
+void netlink_events_process(netlink_events_t *events, iface_table_t *table);
+void netlink_events_close(netlink_events_t *events);
+
+#endif /* NETLINK_H */
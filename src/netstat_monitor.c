@@ -21,460 +21,980 @@
 #include <string.h>
 #include <errno.h>
 #include <unistd.h>
-#include <signal.h>
 #include <time.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <sys/types.h>
 
-#define PROC_NET_DEV "/proc/net/dev"
-#define MAX_LINE_LEN 1024
-#define MAX_IFACE_LEN 64
+#include "netstat_monitor.h"
+#include "iface_table.h"
+#include "iface_soa.h"
+#include "iface_filter.h"
+#include "rate.h"
+#include "procfs.h"
+#include "netlink.h"
+#include "collector.h"
+#include "scheduler.h"
+#include "output.h"
+#include "timestamp.h"
+#include "record.h"
+#include "history.h"
+#include "exporter.h"
+#include "shm_stats.h"
+#include "event_loop.h"
+#include "sampler.h"
+
 #define DEFAULT_INTERVAL 2
 #define HEADER_INTERVAL 20
 
-typedef struct {
-    char interface[MAX_IFACE_LEN];
-    uint64_t rx_bytes;
-    uint64_t rx_packets;
-    uint64_t rx_errors;
-    uint64_t rx_drops;
-    uint64_t tx_bytes;
-    uint64_t tx_packets;
-    uint64_t tx_errors;
-    uint64_t tx_drops;
-    struct timespec timestamp;
-    bool valid;
-} net_stats_t;
-
-static volatile sig_atomic_t keep_running = 1;
-
 static void print_usage(const char *progname);
-static void signal_handler(int signum);
-static bool read_net_stats(const char *interface, net_stats_t *stats);
-static bool parse_interface_line(const char *line, const char *interface, net_stats_t *stats);
-static void format_bytes(uint64_t bytes, char *buffer, size_t bufsize);
-static void format_rate(double rate, char *buffer, size_t bufsize);
-static uint64_t safe_delta(uint64_t current, uint64_t previous);
-static double calculate_rate(uint64_t delta, double elapsed_seconds);
-static void print_header(void);
-static void print_stats(const net_stats_t *current, const net_stats_t *previous, double elapsed);
-static double timespec_diff(const struct timespec *start, const struct timespec *end);
 
 /**
  * Print usage
  */
 static void print_usage(const char *progname) {
-    printf("Usage: %s <interface> [OPTIONS]\n", progname);
+    printf("Usage: %s <interface>... [OPTIONS]\n", progname);
+    printf("       %s decode <file> [--format table|json]\n", progname);
+    printf("       %s history <file> [--format table|json]\n", progname);
+    printf("       %s shm [<name>] [--format table|json]\n", progname);
     printf("\nMonitor real-time network interface statistics from /proc/net/dev\n");
     printf("\nArguments:\n");
-    printf("  <interface>              Network interface to monitor (e.g., eth0, ppp0, lo)\n");
+    printf("  <interface>...           Network interfaces to monitor (e.g., eth0, ppp0, lo)\n");
+    printf("                           or 'all' to monitor every interface\n");
     printf("\nOptions:\n");
-    printf("  -i, --interval <seconds> Update interval in seconds (default: %d)\n", DEFAULT_INTERVAL);
+    printf("  -i, --interval <time>    Update interval in seconds (default: %d); accepts\n", DEFAULT_INTERVAL);
+    printf("                           fractions and ms/us suffixes, e.g. 0.01 or 10ms\n");
     printf("  -n, --count <iterations> Number of iterations (default: unlimited)\n");
+    printf("      --source <name>      Statistics source: auto (default), procfs, netlink\n");
+    printf("                           or sysfs; auto uses sysfs when watching only a\n");
+    printf("                           small fraction of the system's interfaces\n");
+    printf("      --format <name>      Output format: table (default), json (one JSON object\n");
+    printf("                           per interface per tick) or binary (compact\n");
+    printf("                           delta-encoded capture, read back with decode)\n");
+    printf("      --burst <time>       Sample every <time> (e.g. 10ms) but report once per\n");
+    printf("                           interval with the min, mean and peak sub-interval rates\n");
+    printf("      --history <file>     Keep the last --history-span of samples in a\n");
+    printf("                           fixed-size memory-mapped ring file\n");
+    printf("      --history-span <time> Time covered by --history (default: 1h)\n");
+    printf("      --metrics <[host:]port> Serve Prometheus metrics at /metrics\n");
+    printf("                           (host defaults to 127.0.0.1)\n");
+    printf("      --shm <name>         Publish the latest counters and rates in POSIX\n");
+    printf("                           shared memory, e.g. --shm netstat_monitor\n");
+    printf("      --include <pattern>  Watch every interface matching <pattern>, a glob\n");
+    printf("                           (eth*) or an extended regex after re: (re:bond[0-9]+)\n");
+    printf("      --exclude <pattern>  Skip matching interfaces found by 'all' or --include\n");
+    printf("      --replay <file>      Replay concatenated /proc/net/dev snapshots from file\n");
+    printf("      --scanner <name>     /proc/net/dev scanner: auto, scalar, sse2, avx2\n");
+    printf("                           (default: auto, the fastest the CPU supports)\n");
+    printf("      --reopen             Reopen /proc/net/dev on every sample instead of\n");
+    printf("                           re-reading one descriptor with pread()\n");
     printf("  -h, --help               Display this help message\n");
     printf("\nExamples:\n");
     printf("  %s eth0                  Monitor eth0 with default settings\n", progname);
     printf("  %s ppp0 -i 1 -n 60       Monitor ppp0 every 1 second for 60 iterations\n", progname);
+    printf("  %s eth0 eth1 lo          Monitor three interfaces from one /proc/net/dev read\n", progname);
+    printf("  %s all -i 5              Monitor every interface every 5 seconds\n", progname);
+    printf("  %s eth0 -i 10ms          Sample eth0 at 100 Hz\n", progname);
+    printf("  %s eth0 --burst 1ms      Report eth0 microbursts every 2 seconds\n", progname);
+    printf("  %s all --format json     Stream every interface as JSON Lines\n", progname);
+    printf("  %s all --exclude lo      Monitor every interface except loopback\n", progname);
+    printf("  %s --include 'eth*' --include 're:bond[0-9]+'   Watch eth and bond devices\n",
+           progname);
+    printf("  %s all -i 1ms --format binary > cap   Capture at 1 kHz\n", progname);
+    printf("  %s decode cap            Print a binary capture as a table\n", progname);
+    printf("  %s all --history h.ring  Keep the last hour of samples in h.ring\n", progname);
+    printf("  %s all --metrics 9100    Serve every interface to Prometheus\n", progname);
+    printf("  %s shm                   Print the latest sample published with --shm\n", progname);
+    printf("  %s history h.ring        Print the samples in h.ring, even while it is written\n", progname);
     printf("\nSignals:\n");
     printf("  SIGINT (Ctrl+C), SIGTERM Gracefully exit and print summary\n");
     printf("\n");
 }
 
 /**
- * Signal handler for graceful shutdown
+ * Warn once about a slot the latest sample did not see; returns true
+ * the first time, while the slot still has a baseline
  */
-static void signal_handler(int signum) {
-    (void)signum;
-    keep_running = 0;
+static bool report_gone(const iface_soa_t *view, size_t id) {
+    if (view->seen[id] || !view->has_previous[id]) {
+        return false;
+    }
+    fprintf(stderr, "\nWarning: Failed to read stats for %s "
+            "(interface may have disappeared)\n", iface_soa_name(view, id));
+    return true;
 }
 
 /**
- * Calculate time difference in seconds between two timespec structures
+ * Say which interfaces a sample reports as renamed or removed, while the
+ * view still has their old names. New baselines for links created again
+ * or ids given to new interfaces need no message
  */
-static double timespec_diff(const struct timespec *start, const struct timespec *end) {
-    double diff = (end->tv_sec - start->tv_sec);
-    diff += (end->tv_nsec - start->tv_nsec) / 1e9;
-    return diff;
+static void report_changes(const sample_t *sample, const iface_soa_t *view) {
+    for (size_t k = 0; k < sample->change_count; k++) {
+        const sample_change_t *change = &sample->changes[k];
+        if (change->id >= view->count || (change->changes & IFACE_CHANGE_RESTARTED)) {
+            continue;
+        }
+        const char *name = iface_soa_name(view, change->id);
+        if (change->changes & IFACE_CHANGE_DESELECTED) {
+            fprintf(stderr, "\nInterface %s was renamed to %s (no longer selected)\n",
+                    name, change->name);
+        } else if (change->changes & IFACE_CHANGE_REMOVED) {
+            fprintf(stderr, "\nInterface %s was removed\n", name);
+        } else if (strcmp(name, change->name) != 0) {
+            fprintf(stderr, "\nInterface %s was renamed to %s\n", name, change->name);
+        }
+    }
 }
 
 /**
- * Safely compute delta between two counter values, handling wraparound
- * Assumes 64-bit counters, but handles 32-bit wraparound gracefully
+ * Fold the rates of the sample just collected into each slot's burst
+ * statistics
  */
-static uint64_t safe_delta(uint64_t current, uint64_t previous) {
-    if (current >= previous) {
-        return current - previous;
+static void collect_bursts(iface_soa_t *view) {
+    for (size_t i = 0; i < view->count; i++) {
+        report_gone(view, i);
+        if (view->seen[i] && view->has_previous[i]) {
+            burst_add(&view->burst[i], view->rate[IFACE_RX_BYTES][i],
+                      view->rate[IFACE_TX_BYTES][i], view->rate[IFACE_RX_PACKETS][i],
+                      view->rate[IFACE_TX_PACKETS][i]);
+        }
     }
-    /* Counter wrapped around - assume 32-bit wraparound */
-    return (UINT64_C(0x100000000) - previous) + current;
 }
 
 /**
- * Calculate rate per second from delta and elapsed time
+ * Validate an interface name given on the command line
  */
-static double calculate_rate(uint64_t delta, double elapsed_seconds) {
-    if (elapsed_seconds <= 0.0) {
-        return 0.0;
+static bool valid_interface_name(const char *name) {
+    size_t len = strlen(name);
+    if (len == 0 || len >= MAX_IFACE_LEN) {
+        return false;
     }
-    return (double)delta / elapsed_seconds;
+    return strpbrk(name, ": \t\n") == NULL;
 }
 
 /**
- * Format bytes with human-readable units (B, KB, MB, GB)
+ * decode <file> [--format table|json]: print a binary capture
  */
-static void format_bytes(uint64_t bytes, char *buffer, size_t bufsize) {
-    const char *units[] = {"B", "KB", "MB", "GB", "TB"};
-    int unit_idx = 0;
-    double value = (double)bytes;
-    
-    while (value >= 1024.0 && unit_idx < 4) {
-        value /= 1024.0;
-        unit_idx++;
-    }
-    
-    if (unit_idx == 0) {
-        snprintf(buffer, bufsize, "%llu %s", (unsigned long long)bytes, units[unit_idx]);
-    } else {
-        snprintf(buffer, bufsize, "%.1f %s", value, units[unit_idx]);
+static int decode_main(int argc, char *argv[]) {
+    output_format_t format = OUTPUT_TABLE;
+    const char *path = NULL;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            if (!output_parse_format(argv[++i], &format) || format == OUTPUT_BINARY) {
+                fprintf(stderr, "Error: Cannot decode to format: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            fprintf(stderr, "Error: Unexpected decode argument: %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "Error: decode requires a capture file\n");
+        return EXIT_FAILURE;
     }
+    return record_decode(path, format) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
 /**
- * Format rate (bytes/sec or packets/sec) with appropriate units
+ * history <file> [--format table|json]: print a history file
  */
-static void format_rate(double rate, char *buffer, size_t bufsize) {
-    const char *units[] = {"B/s", "KB/s", "MB/s", "GB/s"};
-    int unit_idx = 0;
-    double value = rate;
-    
-    while (value >= 1024.0 && unit_idx < 3) {
-        value /= 1024.0;
-        unit_idx++;
-    }
-    
-    if (rate < 1.0) {
-        snprintf(buffer, bufsize, "0 B/s");
-    } else if (unit_idx == 0) {
-        snprintf(buffer, bufsize, "%.0f %s", value, units[unit_idx]);
-    } else {
-        snprintf(buffer, bufsize, "%.1f %s", value, units[unit_idx]);
+static int history_main(int argc, char *argv[]) {
+    output_format_t format = OUTPUT_TABLE;
+    const char *path = NULL;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            if (!output_parse_format(argv[++i], &format) || format == OUTPUT_BINARY) {
+                fprintf(stderr, "Error: Cannot print history as format: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            fprintf(stderr, "Error: Unexpected history argument: %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "Error: history requires a history file\n");
+        return EXIT_FAILURE;
     }
+    return history_dump(path, format) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
 /**
- * Parse a single line from /proc/net/dev for the specified interface
- * Expected format: "  eth0: 12345 678 ..."
- * Returns true if line matches interface and parsing succeeds
+ * shm [<name>] [--format table|json]: print the latest published sample
  */
-static bool parse_interface_line(const char *line, const char *interface, net_stats_t *stats) {
-    char iface_name[MAX_IFACE_LEN];
-    char line_copy[MAX_LINE_LEN];
+static int shm_main(int argc, char *argv[]) {
+    output_format_t format = OUTPUT_TABLE;
+    const char *name = SHM_STATS_DEFAULT_NAME;
+    bool named = false;
 
-    strncpy(line_copy, line, sizeof(line_copy) - 1);
-    line_copy[sizeof(line_copy) - 1] = '\0';
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            if (!output_parse_format(argv[++i], &format) || format == OUTPUT_BINARY) {
+                fprintf(stderr, "Error: Cannot print shared memory as format: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (argv[i][0] != '-' && !named) {
+            name = argv[i];
+            named = true;
+        } else {
+            fprintf(stderr, "Error: Unexpected shm argument: %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
 
-    char *colon = strchr(line_copy, ':');
-    if (!colon) {
-        return false;
+    shm_stats_reader_t reader;
+    if (!shm_stats_open(&reader, name)) {
+        return EXIT_FAILURE;
     }
 
-    *colon = '\0';
-    const char *iface_start = line_copy;
-    while (*iface_start == ' ' || *iface_start == '\t') {
-        iface_start++;
+    int status = EXIT_FAILURE;
+    shm_stats_info_t info;
+    output_t out = {0};
+    timestamp_cache_t clock;
+    size_t capacity = shm_stats_capacity(&reader);
+    shm_stats_entry_t *entries = malloc((capacity ? capacity : 1) * sizeof(*entries));
+
+    if (!entries) {
+        fprintf(stderr, "Error: Cannot allocate %zu entries: %s\n", capacity, strerror(errno));
+        goto out;
+    }
+    shm_stats_status_t snapshot = shm_stats_read(&reader, entries, capacity, &info);
+    if (snapshot == SHM_STATS_EMPTY) {
+        fprintf(stderr, "Error: Nothing has been published yet\n");
+        goto out;
+    }
+    if (snapshot == SHM_STATS_BUSY) {
+        if (shm_stats_writer_alive(info.pid)) {
+            fprintf(stderr, "Error: The segment stayed busy; pid %lld is still publishing\n",
+                    (long long)info.pid);
+        } else {
+            fprintf(stderr, "Error: The segment is stale; pid %lld exited mid-publish\n",
+                    (long long)info.pid);
+        }
+        goto out;
+    }
+
+    timestamp_cache_init(&clock, info.interval_ns < NSEC_PER_SEC);
+    if (!output_init(&out, STDOUT_FILENO, timestamp_width(&clock))) {
+        goto out;
+    }
+    struct timespec when = {
+        .tv_sec = (time_t)(info.time_ns / NSEC_PER_SEC),
+        .tv_nsec = (long)(info.time_ns % NSEC_PER_SEC),
+    };
+    const char *timestamp = timestamp_format(&clock, &when);
+    if (format == OUTPUT_TABLE) {
+        output_table_header(&out, false);
     }
+    for (size_t i = 0; i < info.count; i++) {
+        const shm_stats_entry_t *entry = &entries[i];
+        if (!entry->current.valid) {
+            continue;
+        }
+        const net_stats_t *previous = entry->previous.valid ? &entry->previous : NULL;
+        if (format == OUTPUT_JSON) {
+            output_json_row(&out, &when, &entry->current, previous, entry->elapsed);
+        } else {
+            output_stats_row(&out, timestamp, &entry->current, previous, entry->elapsed);
+        }
+    }
+    if (output_flush(&out)) {
+        status = EXIT_SUCCESS;
+    }
+
+out:
+    output_free(&out);
+    free(entries);
+    shm_stats_close(&reader);
+    return status;
+}
 
-    strncpy(iface_name, iface_start, sizeof(iface_name) - 1);
-    iface_name[sizeof(iface_name) - 1] = '\0';
+/*
+ * Everything a monitoring run owns: its settings from the command line,
+ * the sampler thread's collector, table, scheduler and link events, and
+ * the output thread's view, sinks and per-tick state
+ */
+typedef struct {
+    collector_options_t options;
+    stats_source_t source;
+    bool procfs_options;
+    uint64_t interval_ns;
+    uint64_t burst_ns;
+    uint64_t burst_ratio;
+    output_format_t format;
+    int max_iterations;
+    const char *history_path;
+    uint64_t history_span_ns;
+    const char *metrics_address;
+    const char *shm_name;
+    size_t capacity;
+
+    iface_filter_t filter;
+    iface_table_t table;
+    collector_t collector;
+    scheduler_t sched;
+    netlink_events_t events;
+    sampler_t sampler;
+    event_loop_t loop;
+
+    iface_soa_t view;
+    output_t out;
+    record_state_t records;
+    history_t history;
+    exporter_t exporter;
+    shm_stats_t shm;
+    timestamp_cache_t clock;
+    FILE *info;
+
+    int iteration;
+    int lines_since_header;
+    uint64_t report_period;
+    uint64_t grid;
+    struct timespec wall;
+} monitor_t;
+
+typedef enum {
+    OPTION_UNKNOWN,
+    OPTION_OK,
+    OPTION_INVALID
+} option_status_t;
 
-    size_t len = strlen(iface_name);
-    while (len > 0 && (iface_name[len - 1] == ' ' || iface_name[len - 1] == '\t')) {
-        iface_name[--len] = '\0';
+/**
+ * Take the argument of the option at argv[*i], moving past it
+ */
+static const char *option_arg(int argc, char *argv[], int *i) {
+    if (*i + 1 >= argc) {
+        fprintf(stderr, "Error: %s requires an argument\n", argv[*i]);
+        return NULL;
     }
+    return argv[++*i];
+}
 
-    if (strcmp(iface_name, interface) != 0) {
-        return false;
+/**
+ * Parse an option that chooses what is sampled and how often
+ */
+static option_status_t parse_sampling_option(monitor_t *m, int argc, char *argv[], int *i) {
+    const char *opt = argv[*i];
+    const char *arg;
+
+    if (strcmp(opt, "--reopen") == 0) {
+        m->options.reopen = true;
+        m->procfs_options = true;
+        return OPTION_OK;
+    }
+    if (strcmp(opt, "-i") != 0 && strcmp(opt, "--interval") != 0 &&
+        strcmp(opt, "-n") != 0 && strcmp(opt, "--count") != 0 &&
+        strcmp(opt, "--source") != 0 && strcmp(opt, "--include") != 0 &&
+        strcmp(opt, "--exclude") != 0 && strcmp(opt, "--replay") != 0 &&
+        strcmp(opt, "--scanner") != 0) {
+        return OPTION_UNKNOWN;
+    }
+    if (!(arg = option_arg(argc, argv, i))) {
+        return OPTION_INVALID;
     }
 
-    char *token_ptr = colon + 1;
-    char *saveptr = NULL;
-    unsigned long long values[16];
-    int token_count = 0;
+    if (strcmp(opt, "-i") == 0 || strcmp(opt, "--interval") == 0) {
+        if (!scheduler_parse_interval(arg, &m->interval_ns)) {
+            fprintf(stderr, "Error: Invalid interval: %s (minimum 1ms)\n", arg);
+            return OPTION_INVALID;
+        }
+    } else if (strcmp(opt, "-n") == 0 || strcmp(opt, "--count") == 0) {
+        m->max_iterations = atoi(arg);
+        if (m->max_iterations <= 0) {
+            fprintf(stderr, "Error: Invalid count: %d\n", m->max_iterations);
+            return OPTION_INVALID;
+        }
+    } else if (strcmp(opt, "--source") == 0) {
+        if (!collector_parse_source(arg, &m->source) || m->source == SOURCE_REPLAY) {
+            fprintf(stderr, "Error: Unknown source: %s\n", arg);
+            return OPTION_INVALID;
+        }
+    } else if (strcmp(opt, "--include") == 0 || strcmp(opt, "--exclude") == 0) {
+        if (!iface_filter_add(&m->filter, arg, strcmp(opt, "--exclude") == 0)) {
+            return OPTION_INVALID;
+        }
+    } else if (strcmp(opt, "--replay") == 0) {
+        m->options.replay_path = arg;
+    } else {
+        m->options.scanner = procfs_scanner_get(arg);
+        m->procfs_options = true;
+        if (!m->options.scanner) {
+            fprintf(stderr, "Error: Scanner '%s' is unknown or unsupported on this CPU\n", arg);
+            return OPTION_INVALID;
+        }
+    }
+    return OPTION_OK;
+}
 
-    char *token = strtok_r(token_ptr, " \t\n\r", &saveptr);
-    while (token && token_count < 16) {
-        char *endptr;
-        errno = 0;
-        values[token_count] = strtoull(token, &endptr, 10);
+/**
+ * Parse an option that chooses how and where samples are reported
+ */
+static option_status_t parse_output_option(monitor_t *m, int argc, char *argv[], int *i) {
+    const char *opt = argv[*i];
+    const char *arg;
+
+    if (strcmp(opt, "--format") != 0 && strcmp(opt, "--burst") != 0 &&
+        strcmp(opt, "--history") != 0 && strcmp(opt, "--history-span") != 0 &&
+        strcmp(opt, "--metrics") != 0 && strcmp(opt, "--shm") != 0) {
+        return OPTION_UNKNOWN;
+    }
+    if (!(arg = option_arg(argc, argv, i))) {
+        return OPTION_INVALID;
+    }
 
-        if (errno != 0 || *endptr != '\0') {
+    if (strcmp(opt, "--format") == 0) {
+        if (!output_parse_format(arg, &m->format)) {
+            fprintf(stderr, "Error: Unknown format: %s\n", arg);
+            return OPTION_INVALID;
+        }
+    } else if (strcmp(opt, "--burst") == 0) {
+        if (!scheduler_parse_interval(arg, &m->burst_ns)) {
+            fprintf(stderr, "Error: Invalid burst period: %s (minimum 1ms)\n", arg);
+            return OPTION_INVALID;
+        }
+    } else if (strcmp(opt, "--history") == 0) {
+        m->history_path = arg;
+    } else if (strcmp(opt, "--history-span") == 0) {
+        if (!scheduler_parse_interval(arg, &m->history_span_ns)) {
+            fprintf(stderr, "Error: Invalid history span: %s\n", arg);
+            return OPTION_INVALID;
+        }
+    } else if (strcmp(opt, "--metrics") == 0) {
+        m->metrics_address = arg;
+    } else {
+        m->shm_name = arg;
+    }
+    return OPTION_OK;
+}
+
+/**
+ * Parse the command line into options and the interfaces to watch
+ */
+static bool parse_args(monitor_t *m, int argc, char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] == '-') {
+            option_status_t status = parse_sampling_option(m, argc, argv, &i);
+            if (status == OPTION_UNKNOWN) {
+                status = parse_output_option(m, argc, argv, &i);
+            }
+            if (status == OPTION_UNKNOWN) {
+                fprintf(stderr, "Error: Unknown option: %s\n", argv[i]);
+                print_usage(argv[0]);
+            }
+            if (status != OPTION_OK) {
+                return false;
+            }
+        } else if (strcmp(argv[i], "all") == 0) {
+            m->table.watch_all = true;
+        } else if (!valid_interface_name(argv[i])) {
+            fprintf(stderr, "Error: Invalid interface name: %s\n", argv[i]);
+            return false;
+        } else if (!iface_table_find(&m->table, argv[i]) &&
+                   !iface_table_add(&m->table, argv[i])) {
             return false;
         }
-        
-        token_count++;
-        token = strtok_r(NULL, " \t\n\r", &saveptr);
     }
+    return true;
+}
 
-    if (token_count < 16) {
+/**
+ * Check that the options parsed make sense together
+ */
+static bool check_args(monitor_t *m, const char *progname) {
+    /* Include patterns select from every interface, like 'all' */
+    if (m->filter.include_count) {
+        m->table.watch_all = true;
+    }
+    if (m->filter.exclude_count && !m->table.watch_all) {
+        fprintf(stderr, "Error: --exclude needs 'all' or --include\n");
         return false;
     }
+    if (!iface_filter_empty(&m->filter)) {
+        m->table.filter = &m->filter;
+    }
 
-    strncpy(stats->interface, interface, sizeof(stats->interface) - 1);
-    stats->interface[sizeof(stats->interface) - 1] = '\0';
-    stats->rx_bytes = values[0];
-    stats->rx_packets = values[1];
-    stats->rx_errors = values[2];
-    stats->rx_drops = values[3];
-    stats->tx_bytes = values[8];
-    stats->tx_packets = values[9];
-    stats->tx_errors = values[10];
-    stats->tx_drops = values[11];
+    if (m->table.count == 0 && !m->table.watch_all) {
+        fprintf(stderr, "Error: No interface specified\n\n");
+        print_usage(progname);
+        return false;
+    }
 
-    stats->valid = true;
+    /* Report on a whole number of sub-samples */
+    if (m->burst_ns) {
+        if (m->burst_ns >= m->interval_ns) {
+            fprintf(stderr, "Error: Burst period must be shorter than the interval\n");
+            return false;
+        }
+        m->burst_ratio = m->interval_ns / m->burst_ns;
+        m->interval_ns = m->burst_ratio * m->burst_ns;
+        if (m->format == OUTPUT_BINARY) {
+            fprintf(stderr, "Error: --burst cannot be combined with --format binary\n");
+            return false;
+        }
+    }
+    if (m->format == OUTPUT_BINARY && isatty(STDOUT_FILENO)) {
+        fprintf(stderr, "Error: Refusing to write a binary capture to a terminal\n");
+        return false;
+    }
     return true;
 }
 
 /**
- * Read network statistics for specified interface from /proc/net/dev
- * Returns true on success, false if interface not found or error
+ * Open the statistics source and take the first sample, which must see
+ * every interface named on the command line
  */
-static bool read_net_stats(const char *interface, net_stats_t *stats) {
-    FILE *fp = fopen(PROC_NET_DEV, "r");
-    if (!fp) {
-        fprintf(stderr, "Error: Cannot open %s: %s\n", PROC_NET_DEV, strerror(errno));
+static bool open_source(monitor_t *m) {
+    iface_table_t *table = &m->table;
+
+    if (m->options.replay_path) {
+        m->source = SOURCE_REPLAY;
+    } else if (m->source == SOURCE_AUTO && m->procfs_options) {
+        m->source = SOURCE_PROCFS;
+    }
+    if (!collector_init(&m->collector, m->source, &m->options, table) ||
+        !collector_sample(&m->collector, table)) {
         return false;
     }
-    
-    char line[MAX_LINE_LEN];
-    bool found = false;
-    int line_num = 0;
-    
-    while (fgets(line, sizeof(line), fp)) {
-        line_num++;
 
-        if (line_num <= 2) {
-            continue;
+    bool missing = false;
+    for (size_t i = 0; i < table->count; i++) {
+        if (!table->slots[i].seen) {
+            fprintf(stderr, "Error: Interface '%s' not found via %s\n",
+                    table->slots[i].current.interface, m->collector.ops->name);
+            missing = true;
+        }
+    }
+    if (missing || table->count == 0) {
+        if (table->count == 0) {
+            fprintf(stderr, "Error: No interfaces %s via %s\n",
+                    table->filter ? "match the patterns" : "found", m->collector.ops->name);
         }
+        print_available_interfaces();
+        return false;
+    }
+    return true;
+}
 
-        if (parse_interface_line(line, interface, stats)) {
-            found = true;
+/**
+ * Build the output thread's copy of the table, in columns
+ */
+static bool init_view(monitor_t *m) {
+    iface_soa_t *view = &m->view;
 
-            if (clock_gettime(CLOCK_MONOTONIC, &stats->timestamp) != 0) {
-                fprintf(stderr, "Warning: clock_gettime failed: %s\n", strerror(errno));
-                stats->timestamp.tv_sec = 0;
-                stats->timestamp.tv_nsec = 0;
-            }
-            
-            break;
+    for (size_t i = 0; i < m->table.count; i++) {
+        const net_stats_t *stats = &m->table.slots[i].current;
+        if (!iface_soa_add(view, stats->interface, strlen(stats->interface))) {
+            return false;
         }
+        view->current[IFACE_RX_BYTES][i] = stats->rx_bytes;
+        view->current[IFACE_RX_PACKETS][i] = stats->rx_packets;
+        view->current[IFACE_RX_ERRORS][i] = stats->rx_errors;
+        view->current[IFACE_RX_DROPS][i] = stats->rx_drops;
+        view->current[IFACE_TX_BYTES][i] = stats->tx_bytes;
+        view->current[IFACE_TX_PACKETS][i] = stats->tx_packets;
+        view->current[IFACE_TX_ERRORS][i] = stats->tx_errors;
+        view->current[IFACE_TX_DROPS][i] = stats->tx_drops;
+        view->time_ns[i] = (int64_t)stats->timestamp.tv_sec * (int64_t)NSEC_PER_SEC +
+                           stats->timestamp.tv_nsec;
+        view->seen[i] = m->table.slots[i].seen;
     }
-    
-    fclose(fp);
-    return found;
+    return true;
 }
 
-static void print_header(void) {
-    printf("\n");
-    printf("%-19s %-10s %15s %12s %10s %10s %8s %8s %15s %12s %10s %10s %8s %8s\n",
-           "Timestamp", "Interface",
-           "RxBytes", "ΔRx", "RxPkts", "ΔRx(p/s)", "RxErr", "RxDrop",
-           "TxBytes", "ΔTx", "TxPkts", "ΔTx(p/s)", "TxErr", "TxDrop");
-    printf("%-19s %-10s %15s %12s %10s %10s %8s %8s %15s %12s %10s %10s %8s %8s\n",
-           "-------------------", "----------",
-           "---------------", "------------", "----------", "----------", "--------", "--------",
-           "---------------", "------------", "----------", "----------", "--------", "--------");
-}
+/**
+ * Open the view and every sink the options asked for
+ */
+static bool open_outputs(monitor_t *m) {
+    if (m->metrics_address && !exporter_open(&m->exporter, m->metrics_address, &m->loop)) {
+        return false;
+    }
+
+    /* Leave room for interfaces that appear later when watching all */
+    m->capacity = m->table.count;
+    if (m->table.watch_all) {
+        m->capacity = m->table.count * 2 > IFACE_TABLE_RESERVE ? m->table.count * 2
+                                                               : IFACE_TABLE_RESERVE;
+    }
+    if (!init_view(m)) {
+        return false;
+    }
 
+    if (m->history_path && !history_open(&m->history, m->history_path, m->history_span_ns,
+                                         m->interval_ns, &m->view, m->capacity)) {
+        return false;
+    }
+    if (m->shm_name && !shm_stats_create(&m->shm, m->shm_name, m->interval_ns,
+                                                m->capacity)) {
+        return false;
+    }
 
-static void print_stats(const net_stats_t *current, const net_stats_t *previous, double elapsed) {
-    char timestamp[32];
-    time_t now = time(NULL);
-    struct tm *tm_info = localtime(&now);
-    strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", tm_info);
-    
-    char rx_bytes_str[32], tx_bytes_str[32];
-    format_bytes(current->rx_bytes, rx_bytes_str, sizeof(rx_bytes_str));
-    format_bytes(current->tx_bytes, tx_bytes_str, sizeof(tx_bytes_str));
-
-    char rx_rate_str[32] = "-", tx_rate_str[32] = "-";
-    char rx_pkt_rate_str[32] = "-", tx_pkt_rate_str[32] = "-";
-    
-    if (previous && previous->valid) {
-        uint64_t rx_delta = safe_delta(current->rx_bytes, previous->rx_bytes);
-        uint64_t tx_delta = safe_delta(current->tx_bytes, previous->tx_bytes);
-        uint64_t rx_pkt_delta = safe_delta(current->rx_packets, previous->rx_packets);
-        uint64_t tx_pkt_delta = safe_delta(current->tx_packets, previous->tx_packets);
-        
-        double rx_rate = calculate_rate(rx_delta, elapsed);
-        double tx_rate = calculate_rate(tx_delta, elapsed);
-        double rx_pkt_rate = calculate_rate(rx_pkt_delta, elapsed);
-        double tx_pkt_rate = calculate_rate(tx_pkt_delta, elapsed);
-        
-        format_rate(rx_rate, rx_rate_str, sizeof(rx_rate_str));
-        format_rate(tx_rate, tx_rate_str, sizeof(tx_rate_str));
-        snprintf(rx_pkt_rate_str, sizeof(rx_pkt_rate_str), "%.0f", rx_pkt_rate);
-        snprintf(tx_pkt_rate_str, sizeof(tx_pkt_rate_str), "%.0f", tx_pkt_rate);
-    }
-    
-    printf("%-19s %-10s %15s %12s %10llu %10s %8llu %8llu %15s %12s %10llu %10s %8llu %8llu\n",
-           timestamp, current->interface,
-           rx_bytes_str, rx_rate_str,
-           (unsigned long long)current->rx_packets, rx_pkt_rate_str,
-           (unsigned long long)current->rx_errors,
-           (unsigned long long)current->rx_drops,
-           tx_bytes_str, tx_rate_str,
-           (unsigned long long)current->tx_packets, tx_pkt_rate_str,
-           (unsigned long long)current->tx_errors,
-           (unsigned long long)current->tx_drops);
+    /* Keep stdout machine-readable; the banner and summary go to stderr */
+    m->info = m->format == OUTPUT_TABLE ? stdout : stderr;
+    /* Sub-second intervals add milliseconds to the timestamp column */
+    timestamp_cache_init(&m->clock, m->interval_ns < NSEC_PER_SEC);
+    return output_init(&m->out, STDOUT_FILENO, timestamp_width(&m->clock)) &&
+           output_attach(&m->out, &m->loop);
 }
 
+/**
+ * Say what is being monitored and how often
+ */
+static void print_banner(const monitor_t *m) {
+    const iface_table_t *table = &m->table;
+    FILE *info = m->info;
+    char interval_str[32];
+
+    scheduler_format_interval(m->interval_ns, interval_str, sizeof(interval_str));
+    if (table->filter) {
+        fprintf(info, "Monitoring interfaces matching the patterns, %zu so far "
+                "(interval: %s seconds", table->count, interval_str);
+    } else if (table->watch_all) {
+        fprintf(info, "Monitoring all interfaces (interval: %s seconds", interval_str);
+    } else if (table->count == 1) {
+        fprintf(info, "Monitoring interface: %s (interval: %s seconds",
+                table->slots[0].current.interface, interval_str);
+    } else {
+        fprintf(info, "Monitoring %zu interfaces (interval: %s seconds",
+                table->count, interval_str);
+    }
+    if (m->burst_ns) {
+        char burst_str[32];
+        scheduler_format_interval(m->burst_ns, burst_str, sizeof(burst_str));
+        fprintf(info, ", burst sampling: %s seconds", burst_str);
+    }
+    if (m->max_iterations > 0) {
+        fprintf(info, ", iterations: %d", m->max_iterations);
+    }
+    fprintf(info, ")\n");
+    fprintf(info, "Press Ctrl+C to stop\n");
+    /* Rows bypass stdio from here on */
+    fflush(info);
+}
 
-int main(int argc, char *argv[]) {
-    const char *interface = NULL;
-    int interval = DEFAULT_INTERVAL;
-    int max_iterations = -1;
+/**
+ * Hand the collector, table, scheduler and link events to the sampler
+ * thread and start the output with its header
+ */
+static bool start_sampling(monitor_t *m) {
+    /* A replay has no live links to follow */
+    if (m->source != SOURCE_REPLAY && !netlink_events_open(&m->events)) {
+        fprintf(stderr, "Warning: Renamed and re-created interfaces will not be tracked\n");
+    }
 
-    for (int i = 1; i < argc; i++) {
-        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-            print_usage(argv[0]);
-            return EXIT_SUCCESS;
-        }
+    clock_gettime(CLOCK_REALTIME, &m->wall);
+    if (!scheduler_init(&m->sched, m->burst_ns ? m->burst_ns : m->interval_ns) ||
+        !sampler_start(&m->sampler, &m->collector, &m->table, &m->sched,
+                       m->events.fd >= 0 ? &m->events : NULL, &m->loop, m->capacity)) {
+        return false;
     }
-    
-    if (argc < 2) {
-        fprintf(stderr, "Error: No interface specified\n\n");
-        print_usage(argv[0]);
-        return EXIT_FAILURE;
+    if (m->format == OUTPUT_TABLE) {
+        output_table_header(&m->out, m->burst_ratio != 0);
+    } else if (m->format == OUTPUT_BINARY) {
+        clock_gettime(CLOCK_REALTIME, &m->wall);
+        record_write_header(&m->records, &m->out, m->interval_ns, &m->wall);
     }
-    
-    interface = argv[1];
-    
-    for (int i = 2; i < argc; i++) {
-        if (strcmp(argv[i], "-i") == 0 || strcmp(argv[i], "--interval") == 0) {
-            if (i + 1 >= argc) {
-                fprintf(stderr, "Error: %s requires an argument\n", argv[i]);
-                return EXIT_FAILURE;
+    return true;
+}
+
+/**
+ * Have captures and history drop baselines and learn names like the
+ * view did; shm takes both from the view
+ */
+static void apply_changes(monitor_t *m, const sample_t *sample) {
+    for (size_t k = 0; k < sample->change_count; k++) {
+        const sample_change_t *change = &sample->changes[k];
+        if (change->changes & (IFACE_CHANGE_RESTARTED | IFACE_CHANGE_REMOVED)) {
+            if (m->format == OUTPUT_BINARY) {
+                record_write_gone(&m->records, &m->out, change->id);
             }
-            interval = atoi(argv[++i]);
-            if (interval <= 0) {
-                fprintf(stderr, "Error: Invalid interval: %d\n", interval);
-                return EXIT_FAILURE;
+            if (m->history.map) {
+                history_restart(&m->history, change->id);
             }
-        } else if (strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "--count") == 0) {
-            if (i + 1 >= argc) {
-                fprintf(stderr, "Error: %s requires an argument\n", argv[i]);
-                return EXIT_FAILURE;
+        }
+        if (change->changes & IFACE_CHANGE_RENAMED) {
+            if (m->format == OUTPUT_BINARY) {
+                record_rename(&m->records, change->id);
             }
-            max_iterations = atoi(argv[++i]);
-            if (max_iterations <= 0) {
-                fprintf(stderr, "Error: Invalid count: %d\n", max_iterations);
-                return EXIT_FAILURE;
+            if (m->history.map) {
+                history_rename(&m->history, &m->view, change->id);
             }
+        }
+    }
+}
+
+/**
+ * Wait for the sampler's next sample and move it into the view; false
+ * at the end of a replay, on a signal or when the view cannot grow
+ */
+static bool next_sample(monitor_t *m) {
+    const sample_t *sample;
+
+    while (!(sample = sampler_peek(&m->sampler))) {
+        if (!event_loop_wait(&m->loop)) {
+            return false;
+        }
+    }
+    if (sample->end) {
+        return false;
+    }
+    report_changes(sample, &m->view);
+    bool ok = sample_apply(sample, &m->view);
+    if (ok) {
+        apply_changes(m, sample);
+    }
+    m->grid = sample->grid;
+    m->wall = sample->wall;
+    sampler_release(&m->sampler);
+    return ok;
+}
+
+/**
+ * Render the burst statistics gathered over the last interval
+ */
+static void render_bursts(monitor_t *m, const char *timestamp) {
+    for (size_t i = 0; i < m->view.count; i++) {
+        burst_stats_t *burst = &m->view.burst[i];
+        if (burst->count == 0) {
+            continue;
+        }
+        if (m->format == OUTPUT_JSON) {
+            output_json_burst_row(&m->out, &m->wall, iface_soa_name(&m->view, i), burst);
         } else {
-            fprintf(stderr, "Error: Unknown option: %s\n", argv[i]);
-            print_usage(argv[0]);
-            return EXIT_FAILURE;
+            output_burst_row(&m->out, timestamp, iface_soa_name(&m->view, i), burst);
         }
+        burst_reset(burst);
+        m->lines_since_header++;
     }
+}
 
-    struct sigaction sa;
-    memset(&sa, 0, sizeof(sa));
-    sa.sa_handler = signal_handler;
-    sigemptyset(&sa.sa_mask);
-    sa.sa_flags = 0;
-    
-    if (sigaction(SIGINT, &sa, NULL) < 0) {
-        fprintf(stderr, "Warning: Cannot install SIGINT handler: %s\n", strerror(errno));
-    }
-    if (sigaction(SIGTERM, &sa, NULL) < 0) {
-        fprintf(stderr, "Warning: Cannot install SIGTERM handler: %s\n", strerror(errno));
-    }
-
-    net_stats_t initial_stats = {0};
-    if (!read_net_stats(interface, &initial_stats)) {
-        fprintf(stderr, "Error: Interface '%s' not found in %s\n", interface, PROC_NET_DEV);
-        fprintf(stderr, "Available interfaces:\n");
-
-        FILE *fp = fopen(PROC_NET_DEV, "r");
-        if (fp) {
-            char line[MAX_LINE_LEN];
-            int line_num = 0;
-            while (fgets(line, sizeof(line), fp)) {
-                line_num++;
-                if (line_num <= 2) continue;
-
-                char *colon = strchr(line, ':');
-                if (colon) {
-                    *colon = '\0';
-                    const char *iface = line;
-                    while (*iface == ' ' || *iface == '\t') iface++;
-
-                    char iface_trimmed[MAX_IFACE_LEN];
-                    strncpy(iface_trimmed, iface, sizeof(iface_trimmed) - 1);
-                    iface_trimmed[sizeof(iface_trimmed) - 1] = '\0';
-
-                    size_t len = strlen(iface_trimmed);
-                    while (len > 0 && (iface_trimmed[len - 1] == ' ' || iface_trimmed[len - 1] == '\t')) {
-                        iface_trimmed[--len] = '\0';
-                    }
-                    
-                    fprintf(stderr, "  %s\n", iface_trimmed);
-                }
+/**
+ * Render a row per interface seen in the latest sample
+ */
+static void render_rows(monitor_t *m, const char *timestamp) {
+    for (size_t i = 0; i < m->view.count; i++) {
+        if (!m->view.seen[i]) {
+            if (report_gone(&m->view, i) && m->format == OUTPUT_BINARY) {
+                record_write_gone(&m->records, &m->out, i);
             }
-            fclose(fp);
+            continue;
         }
-        return EXIT_FAILURE;
+
+        if (m->format == OUTPUT_BINARY) {
+            net_stats_t current;
+            iface_soa_get(&m->view, i, &current, NULL);
+            if (!record_write_sample(&m->records, &m->out, i, &m->wall, &current)) {
+                break;
+            }
+        } else if (m->format == OUTPUT_JSON) {
+            output_json_view_row(&m->out, &m->wall, &m->view, i);
+        } else {
+            output_stats_view_row(&m->out, timestamp, &m->view, i);
+        }
+        m->lines_since_header++;
     }
+}
+
+/**
+ * Render the sample in the view and publish it to every sink; false
+ * once stdout has failed
+ */
+static bool monitor_report(monitor_t *m) {
+    const char *timestamp = NULL;
 
-    net_stats_t current_stats = {0}, previous_stats = {0};
-    int iteration = 0;
-    int lines_since_header = 0;
+    /* Every row of a tick shares the time it was sampled at */
+    if (m->format == OUTPUT_TABLE) {
+        timestamp = timestamp_format(&m->clock, &m->wall);
+    }
 
-    printf("Monitoring interface: %s (interval: %d seconds", interface, interval);
-    if (max_iterations > 0) {
-        printf(", iterations: %d", max_iterations);
+    /* Rows for a stdout that is far behind are skipped, not queued */
+    bool render = !output_congested(&m->out);
+    if (!render) {
+        m->out.dropped++;
+    } else if (m->burst_ratio) {
+        render_bursts(m, timestamp);
+    } else {
+        render_rows(m, timestamp);
     }
-    printf(")\n");
-    printf("Press Ctrl+C to stop\n");
 
-    print_header();
+    if (m->history.map) {
+        history_append(&m->history, &m->view, &m->wall);
+    }
+    if (m->metrics_address) {
+        exporter_publish(&m->exporter, &m->view, &m->wall);
+    }
+    if (m->shm.map) {
+        shm_stats_publish(&m->shm, &m->view, &m->wall);
+    }
 
-    while (keep_running && (max_iterations < 0 || iteration < max_iterations)) {
-        if (!read_net_stats(interface, &current_stats)) {
-            fprintf(stderr, "\nWarning: Failed to read stats for %s (interface may have disappeared)\n",
-                    interface);
-            sleep(interval);
-            continue;
-        }
+    m->iteration++;
 
-        double elapsed = 0.0;
-        if (previous_stats.valid) {
-            elapsed = timespec_diff(&previous_stats.timestamp, &current_stats.timestamp);
-        }
+    if (m->lines_since_header >= HEADER_INTERVAL && m->format == OUTPUT_TABLE && render) {
+        output_table_header(&m->out, m->burst_ratio != 0);
+        m->lines_since_header = 0;
+    }
+
+    /* One write() for everything rendered this tick */
+    return output_flush(&m->out);
+}
+
+/**
+ * Handle the sample in the view: compute its deltas and rates once for
+ * every renderer and sink, report it unless it is a sub-sample inside a
+ * burst interval, then make it the baseline for the next one
+ */
+static bool monitor_tick(monitor_t *m) {
+    bool report = true;
+
+    iface_soa_compute(&m->view);
+    if (m->burst_ratio) {
+        collect_bursts(&m->view);
+        /* Grid position, so that missed sub-samples do not delay reports */
+        uint64_t period = m->grid / m->burst_ratio;
+        report = period != m->report_period;
+        m->report_period = period;
+    }
+    bool ok = !report || monitor_report(m);
+    /* A slot missing from the sample restarts from a fresh baseline */
+    iface_soa_advance(&m->view);
+    return ok;
+}
 
-        print_stats(&current_stats, previous_stats.valid ? &previous_stats : NULL, elapsed);
+/**
+ * Stop the sampler thread and stop watching stdout and signals
+ */
+static void monitor_stop(monitor_t *m) {
+    if (m->sampler.running) {
+        sampler_stop(&m->sampler);
+    }
+    output_detach(&m->out);
+    scheduler_close(&m->sched);
+    event_loop_close(&m->loop);
+}
+
+/**
+ * Say why monitoring ended and summarize the run
+ */
+static void print_summary(const monitor_t *m) {
+    FILE *info = m->info;
+
+    fprintf(info, "\n");
+    if (m->loop.stopped) {
+        fprintf(info, "Monitoring stopped by signal\n");
+    } else if (m->collector.exhausted) {
+        fprintf(info, "Replay finished\n");
+    }
+    fprintf(info, "Total iterations: %d\n", m->iteration);
+    collector_print_summary(&m->collector, info);
+    scheduler_print_summary(&m->sched, info);
+    if (m->metrics_address) {
+        exporter_print_summary(&m->exporter, info);
+    }
+    uint64_t lost = atomic_load(&m->sampler.dropped);
+    if (lost) {
+        fprintf(info, "Sampling: %llu samples dropped while output was behind\n",
+                (unsigned long long)lost);
+    }
+    if (m->out.dropped) {
+        fprintf(info, "Output: %llu ticks dropped while stdout was backed up\n",
+                (unsigned long long)m->out.dropped);
+    }
+}
 
-        previous_stats = current_stats;
+/**
+ * Release everything the run holds, once the sampler has stopped
+ */
+static void monitor_free(monitor_t *m) {
+    collector_close(&m->collector);
+    netlink_events_close(&m->events);
+    output_free(&m->out);
+    record_state_free(&m->records);
+    history_close(&m->history);
+    exporter_close(&m->exporter);
+    shm_stats_destroy(&m->shm);
+    iface_table_free(&m->table);
+    iface_soa_free(&m->view);
+    iface_filter_free(&m->filter);
+}
 
-        iteration++;
-        lines_since_header++;
+/**
+ * Set up from the command line and report every tick until the count
+ * is reached, the replay ends or a signal arrives
+ */
+static bool monitor_run(monitor_t *m, int argc, char *argv[]) {
+    if (!parse_args(m, argc, argv) || !check_args(m, argv[0])) {
+        return false;
+    }
+    /* SIGINT and SIGTERM are read from the loop from here on */
+    if (!event_loop_init(&m->loop) || !open_source(m) || !open_outputs(m)) {
+        return false;
+    }
+    print_banner(m);
+    /* From here on the sampler thread owns collector, table, sched and events */
+    if (!start_sampling(m)) {
+        return false;
+    }
 
-        if (lines_since_header >= HEADER_INTERVAL) {
-            print_header();
-            lines_since_header = 0;
+    /* The sample that validated the interfaces becomes the first row */
+    bool have_sample = true;
+    while (m->max_iterations < 0 || m->iteration < m->max_iterations) {
+        if (!have_sample && !next_sample(m)) {
+            break;
         }
+        have_sample = false;
+        if (!monitor_tick(m)) {
+            break;
+        }
+    }
+
+    /* Drain what a pipe has not taken yet; Ctrl+C can interrupt it again */
+    monitor_stop(m);
+    output_flush(&m->out);
+    print_summary(m);
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    monitor_t monitor = {
+        .interval_ns = (uint64_t)DEFAULT_INTERVAL * NSEC_PER_SEC,
+        .history_span_ns = HISTORY_DEFAULT_SPAN_NS,
+        .max_iterations = -1,
+        .source = SOURCE_AUTO,
+        .format = OUTPUT_TABLE,
+        .events = {.fd = -1},
+        .loop = {.epoll_fd = -1, .signals.fd = -1},
+        .sched = {.timer_fd = -1},
+        .history = {.fd = -1},
+        .exporter = {.listener.fd = -1},
+    };
 
-        if (keep_running && (max_iterations < 0 || iteration < max_iterations)) {
-            sleep(interval);
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            return EXIT_SUCCESS;
         }
     }
+    if (argc > 1 && strcmp(argv[1], "decode") == 0) {
+        return decode_main(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "history") == 0) {
+        return history_main(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "shm") == 0) {
+        return shm_main(argc, argv);
+    }
 
-    printf("\n");
-    if (!keep_running) {
-        printf("Monitoring stopped by signal\n");
+    bool ok = monitor_run(&monitor, argc, argv);
+    if (!ok) {
+        monitor_stop(&monitor);
     }
-    printf("Total iterations: %d\n", iteration);
-    
-    return EXIT_SUCCESS;
+    monitor_free(&monitor);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef NETSTAT_MONITOR_H
+#define NETSTAT_MONITOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#define PROC_NET_DEV "/proc/net/dev"
+#define MAX_IFACE_LEN 64
+#define NSEC_PER_SEC UINT64_C(1000000000)
+
+typedef struct {
+    char interface[MAX_IFACE_LEN];
+    uint64_t rx_bytes;
+    uint64_t rx_packets;
+    uint64_t rx_errors;
+    uint64_t rx_drops;
+    uint64_t tx_bytes;
+    uint64_t tx_packets;
+    uint64_t tx_errors;
+    uint64_t tx_drops;
+    struct timespec timestamp;
+    bool valid;
+} net_stats_t;
+
+/* Per-backend I/O accounting, for comparing the cost of collection sources */
+typedef struct {
+    uint64_t syscalls;
+    uint64_t bytes;
+} io_counters_t;
+
+#endif /* NETSTAT_MONITOR_H */
@@ -0,0 +1,747 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/epoll.h>
+
+#include "output.h"
+#include "rate.h"
+
+typedef struct {
+    const char *suffix;
+    size_t len;
+} unit_t;
+
+static const unit_t byte_units[] = {
+    {" B", 2}, {" KB", 3}, {" MB", 3}, {" GB", 3}, {" TB", 3},
+};
+
+static const unit_t rate_units[] = {
+    {" B/s", 4}, {" KB/s", 5}, {" MB/s", 5}, {" GB/s", 5},
+};
+
+/* Below 2^53 the fixed-point path is exact: (double)bytes == bytes and
+ * ten times the mantissa fits in 64 bits; beyond it, and for NaN, the
+ * original floating-point formatting is used */
+#define FIXED_POINT_LIMIT 9007199254740992.0
+
+static void format_slow(double value, const unit_t *units, int max_unit,
+                        char *buffer, size_t bufsize) {
+    int unit_idx = 0;
+    while (value >= 1024.0 && unit_idx < max_unit) {
+        value /= 1024.0;
+        unit_idx++;
+    }
+    snprintf(buffer, bufsize, unit_idx == 0 ? "%.0f%s" : "%.1f%s", value,
+             units[unit_idx].suffix);
+}
+
+/**
+ * Round m / 2^shift to the nearest integer, ties to even, which is how
+ * printf rounds the exact binary value
+ */
+static inline uint64_t round_shift(uint64_t m, unsigned shift) {
+    if (shift == 0) {
+        return m;
+    }
+    uint64_t q = m >> shift;
+    uint64_t rem = m & ((UINT64_C(1) << shift) - 1);
+    uint64_t half = UINT64_C(1) << (shift - 1);
+    if (rem > half || (rem == half && (q & 1))) {
+        q++;
+    }
+    return q;
+}
+
+/**
+ * Write v in decimal, returning the end of the digits
+ */
+static inline char *put_decimal(char *p, uint64_t v) {
+    char digits[20];
+    size_t n = 0;
+    do {
+        digits[sizeof(digits) - ++n] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    memcpy(p, digits + sizeof(digits) - n, n);
+    return p + n;
+}
+
+/**
+ * Write tenths as "%.1f" would print tenths / 10, then the unit suffix
+ */
+static inline char *put_tenths(char *p, uint64_t tenths, const unit_t *unit) {
+    p = put_decimal(p, tenths / 10);
+    *p++ = '.';
+    *p++ = (char)('0' + tenths % 10);
+    memcpy(p, unit->suffix, unit->len);
+    return p + unit->len;
+}
+
+static inline void copy_out(char *buffer, size_t bufsize, const char *text, size_t len) {
+    if (bufsize == 0) {
+        return;
+    }
+    if (len >= bufsize) {
+        len = bufsize - 1;
+    }
+    memcpy(buffer, text, len);
+    buffer[len] = '\0';
+}
+
+/**
+ * Format bytes with human-readable units (B, KB, MB, GB, TB)
+ * The unit comes from the position of the top bit and the one decimal
+ * from integer fixed-point; the text matches snprintf("%.1f") exactly
+ */
+void format_bytes(uint64_t bytes, char *buffer, size_t bufsize) {
+    char text[32];
+    char *p = text;
+
+    if ((double)bytes >= FIXED_POINT_LIMIT) {
+        format_slow((double)bytes, byte_units, 4, buffer, bufsize);
+        return;
+    }
+
+    unsigned unit_idx = bytes ? (unsigned)(63 - __builtin_clzll(bytes)) / 10 : 0;
+    if (unit_idx > 4) {
+        unit_idx = 4;
+    }
+
+    if (unit_idx == 0) {
+        p = put_decimal(p, bytes);
+        memcpy(p, byte_units[0].suffix, byte_units[0].len);
+        p += byte_units[0].len;
+    } else {
+        p = put_tenths(p, round_shift(bytes * 10, 10 * unit_idx), &byte_units[unit_idx]);
+    }
+    copy_out(buffer, bufsize, text, (size_t)(p - text));
+}
+
+/**
+ * Format rate (bytes/sec or packets/sec) with appropriate units
+ * rate is split into its 53-bit mantissa and exponent, so dividing by
+ * 1024^unit and rounding to one decimal are exact integer operations
+ */
+void format_rate(double rate, char *buffer, size_t bufsize) {
+    char text[32];
+    char *p = text;
+
+    if (rate < 1.0) {
+        copy_out(buffer, bufsize, "0 B/s", 5);
+        return;
+    }
+    if (!(rate < FIXED_POINT_LIMIT)) {
+        format_slow(rate, rate_units, 3, buffer, bufsize);
+        return;
+    }
+
+    unsigned unit_idx = (unsigned)(63 - __builtin_clzll((uint64_t)rate)) / 10;
+    if (unit_idx > 3) {
+        unit_idx = 3;
+    }
+
+    /* rate == mantissa * 2^-shift with 1 <= rate < 2^53 */
+    uint64_t bits;
+    memcpy(&bits, &rate, sizeof(bits));
+    uint64_t mantissa = (bits & ((UINT64_C(1) << 52) - 1)) | (UINT64_C(1) << 52);
+    unsigned shift = 1075 - (unsigned)(bits >> 52) + 10 * unit_idx;
+
+    if (unit_idx == 0) {
+        p = put_decimal(p, round_shift(mantissa, shift));
+        memcpy(p, rate_units[0].suffix, rate_units[0].len);
+        p += rate_units[0].len;
+    } else {
+        p = put_tenths(p, round_shift(mantissa * 10, shift), &rate_units[unit_idx]);
+    }
+    copy_out(buffer, bufsize, text, (size_t)(p - text));
+}
+
+bool output_parse_format(const char *name, output_format_t *format) {
+    if (strcmp(name, "table") == 0) {
+        *format = OUTPUT_TABLE;
+    } else if (strcmp(name, "json") == 0) {
+        *format = OUTPUT_JSON;
+    } else if (strcmp(name, "binary") == 0) {
+        *format = OUTPUT_BINARY;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool output_init(output_t *out, int fd, int timestamp_width) {
+    memset(out, 0, sizeof(*out));
+    out->buf = malloc(OUTPUT_BUFFER_SIZE);
+    if (!out->buf) {
+        fprintf(stderr, "Error: Cannot allocate output buffer: %s\n", strerror(errno));
+        return false;
+    }
+    out->fd = fd;
+    out->capacity = OUTPUT_BUFFER_SIZE;
+    out->timestamp_width = timestamp_width;
+    return true;
+}
+
+void output_free(output_t *out) {
+    free(out->buf);
+    out->buf = NULL;
+    out->len = 0;
+    out->capacity = 0;
+}
+
+/**
+ * Write out everything buffered, resuming after short writes
+ * Returns false if this or an earlier flush failed; like ferror(), the
+ * failure sticks so that rows rendered in between need not be checked
+ * A non-blocking sink keeps what it could not take for the next flush
+ */
+bool output_flush(output_t *out) {
+    size_t done = 0;
+    while (done < out->len && !out->failed) {
+        ssize_t n = write(out->fd, out->buf + done, out->len - done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            fprintf(stderr, "Error: Cannot write output: %s\n", strerror(errno));
+            out->failed = true;
+            break;
+        }
+        done += (size_t)n;
+    }
+    if (out->failed) {
+        done = out->len;
+    }
+    memmove(out->buf, out->buf + done, out->len - done);
+    out->len -= done;
+
+    /* Only wait for EPOLLOUT while something is pending */
+    if (out->loop && out->len > 0 && !out->watching) {
+        out->watching = event_loop_add(out->loop, &out->source, EPOLLOUT);
+    } else if (out->loop && out->len == 0 && out->watching) {
+        event_loop_remove(out->loop, &out->source);
+        out->watching = false;
+    }
+    return !out->failed;
+}
+
+static void on_writable(event_source_t *source, uint32_t events) {
+    (void)events;
+    output_flush(source->ctx);
+}
+
+/**
+ * Stop blocking on a pipe or socket; other sinks such as files and
+ * terminals are left as they are
+ */
+bool output_attach(output_t *out, event_loop_t *loop) {
+    struct stat st;
+
+    if (fstat(out->fd, &st) != 0 || !(S_ISFIFO(st.st_mode) || S_ISSOCK(st.st_mode))) {
+        return true;
+    }
+    out->saved_flags = fcntl(out->fd, F_GETFL);
+    if (out->saved_flags < 0 || fcntl(out->fd, F_SETFL, out->saved_flags | O_NONBLOCK) != 0) {
+        fprintf(stderr, "Error: Cannot make output non-blocking: %s\n", strerror(errno));
+        return false;
+    }
+    out->source.fd = out->fd;
+    out->source.callback = on_writable;
+    out->source.ctx = out;
+    out->loop = loop;
+    return true;
+}
+
+/**
+ * Restore blocking writes, so that the rest can be flushed on exit and
+ * whoever shares the pipe gets it back as it was
+ */
+void output_detach(output_t *out) {
+    if (!out->loop) {
+        return;
+    }
+    if (out->watching) {
+        event_loop_remove(out->loop, &out->source);
+        out->watching = false;
+    }
+    fcntl(out->fd, F_SETFL, out->saved_flags);
+    out->loop = NULL;
+}
+
+/**
+ * Double the buffer when a non-blocking sink leaves no room for a row
+ * If that fails the backlog is discarded and output marked failed
+ */
+bool output_grow(output_t *out) {
+    char *buf = out->failed ? NULL : realloc(out->buf, out->capacity * 2);
+    if (!buf) {
+        if (!out->failed) {
+            fprintf(stderr, "Error: Cannot grow output buffer: %s\n", strerror(errno));
+        }
+        out->failed = true;
+        out->len = 0;
+        return false;
+    }
+    out->buf = buf;
+    out->capacity *= 2;
+    return true;
+}
+
+/* Unchecked appenders; the caller has reserved OUTPUT_ROW_MAX bytes */
+
+static inline char *put_str(char *p, const char *s, size_t len) {
+    memcpy(p, s, len);
+    return p + len;
+}
+
+static inline char *put_spaces(char *p, size_t count) {
+    memset(p, ' ', count);
+    return p + count;
+}
+
+/**
+ * Append s right-aligned in width columns, like printf("%*s")
+ */
+static inline char *put_right(char *p, const char *s, size_t width) {
+    size_t len = strlen(s);
+    if (len < width) {
+        p = put_spaces(p, width - len);
+    }
+    return put_str(p, s, len);
+}
+
+/**
+ * Append s left-aligned in width columns, like printf("%-*s")
+ */
+static inline char *put_left(char *p, const char *s, size_t width) {
+    size_t len = strlen(s);
+    p = put_str(p, s, len);
+    if (len < width) {
+        p = put_spaces(p, width - len);
+    }
+    return p;
+}
+
+/**
+ * Append v right-aligned in width columns, like printf("%*llu")
+ */
+static inline char *put_u64(char *p, uint64_t v, size_t width) {
+    char digits[20];
+    size_t n = 0;
+    do {
+        digits[sizeof(digits) - ++n] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    if (n < width) {
+        p = put_spaces(p, width - n);
+    }
+    return put_str(p, digits + sizeof(digits) - n, n);
+}
+
+/**
+ * Append a non-negative rate right-aligned, like printf("%*.0f")
+ * Ties round to even, as glibc does for the exact binary value
+ */
+static inline char *put_rate0(char *p, double v, size_t width) {
+    if (v < 18446744073709549568.0) {
+        uint64_t whole = (uint64_t)v;
+        double frac = v - (double)whole;
+        if (frac > 0.5 || (frac == 0.5 && (whole & 1))) {
+            whole++;
+        }
+        return put_u64(p, whole, width);
+    }
+    char tmp[32];
+    snprintf(tmp, sizeof(tmp), "%.0f", v);
+    return put_right(p, tmp, width);
+}
+
+static void output_header(output_t *out) {
+    output_reserve(out);
+    int n = snprintf(out->buf + out->len, OUTPUT_ROW_MAX,
+                     "\n%-*s %-10s %15s %12s %10s %10s %8s %8s %15s %12s %10s %10s %8s %8s\n"
+                     "%-*.*s %-10s %15s %12s %10s %10s %8s %8s %15s %12s %10s %10s %8s %8s\n",
+                     out->timestamp_width, "Timestamp", "Interface",
+                     "RxBytes", "ΔRx", "RxPkts", "ΔRx(p/s)", "RxErr", "RxDrop",
+                     "TxBytes", "ΔTx", "TxPkts", "ΔTx(p/s)", "TxErr", "TxDrop",
+                     out->timestamp_width, out->timestamp_width, "-----------------------",
+                     "----------",
+                     "---------------", "------------", "----------", "----------",
+                     "--------", "--------",
+                     "---------------", "------------", "----------", "----------",
+                     "--------", "--------");
+    out->len += (size_t)n;
+}
+
+static void output_burst_header(output_t *out) {
+    output_reserve(out);
+    int n = snprintf(out->buf + out->len, OUTPUT_ROW_MAX,
+                     "\n%-*s %-10s %12s %12s %12s %10s %10s %10s %12s %12s %12s %10s %10s %10s\n"
+                     "%-*.*s %-10s %12s %12s %12s %10s %10s %10s %12s %12s %12s %10s %10s %10s\n",
+                     out->timestamp_width, "Timestamp", "Interface",
+                     "RxMin", "RxMean", "RxPeak", "RxPktMin", "RxPktMean", "RxPktPeak",
+                     "TxMin", "TxMean", "TxPeak", "TxPktMin", "TxPktMean", "TxPktPeak",
+                     out->timestamp_width, out->timestamp_width, "-----------------------",
+                     "----------",
+                     "------------", "------------", "------------",
+                     "----------", "----------", "----------",
+                     "------------", "------------", "------------",
+                     "----------", "----------", "----------");
+    out->len += (size_t)n;
+}
+
+void output_table_header(output_t *out, bool burst) {
+    if (burst) {
+        output_burst_header(out);
+    } else {
+        output_header(out);
+    }
+}
+
+/*
+ * One row's counters and, when rates is set, its deltas and rates over
+ * elapsed seconds, whether they come from a pair of net_stats_t or from
+ * the columns iface_soa_compute() filled for the whole table
+ */
+typedef struct {
+    const char *interface;
+    uint64_t counters[IFACE_COUNTERS];
+    uint64_t delta[IFACE_COUNTERS];
+    double rate[IFACE_COUNTERS];
+    double elapsed;
+    bool rates;
+} output_row_t;
+
+static void row_from_stats(output_row_t *row, const net_stats_t *current,
+                           const net_stats_t *previous, double elapsed) {
+    row->interface = current->interface;
+    row->counters[IFACE_RX_BYTES] = current->rx_bytes;
+    row->counters[IFACE_RX_PACKETS] = current->rx_packets;
+    row->counters[IFACE_RX_ERRORS] = current->rx_errors;
+    row->counters[IFACE_RX_DROPS] = current->rx_drops;
+    row->counters[IFACE_TX_BYTES] = current->tx_bytes;
+    row->counters[IFACE_TX_PACKETS] = current->tx_packets;
+    row->counters[IFACE_TX_ERRORS] = current->tx_errors;
+    row->counters[IFACE_TX_DROPS] = current->tx_drops;
+    row->rates = previous && previous->valid;
+    if (!row->rates) {
+        return;
+    }
+
+    const uint64_t before[IFACE_COUNTERS] = {
+        previous->rx_bytes, previous->rx_packets, previous->rx_errors, previous->rx_drops,
+        previous->tx_bytes, previous->tx_packets, previous->tx_errors, previous->tx_drops,
+    };
+    for (int c = 0; c < IFACE_COUNTERS; c++) {
+        row->delta[c] = safe_delta(row->counters[c], before[c]);
+        row->rate[c] = calculate_rate(row->delta[c], elapsed);
+    }
+    row->elapsed = elapsed;
+}
+
+static void row_from_view(output_row_t *row, const iface_soa_t *view, size_t id) {
+    row->interface = iface_soa_name(view, id);
+    row->rates = view->seen[id] && view->has_previous[id];
+    for (int c = 0; c < IFACE_COUNTERS; c++) {
+        row->counters[c] = view->current[c][id];
+        row->delta[c] = view->delta[c][id];
+        row->rate[c] = view->rate[c][id];
+    }
+    row->elapsed = view->elapsed[id];
+}
+
+static void render_stats_row(output_t *out, const char *timestamp, const output_row_t *row) {
+    char rx_bytes_str[32], tx_bytes_str[32];
+    char rx_rate_str[32] = "-", tx_rate_str[32] = "-";
+    const uint64_t *counters = row->counters;
+
+    output_reserve(out);
+
+    format_bytes(counters[IFACE_RX_BYTES], rx_bytes_str, sizeof(rx_bytes_str));
+    format_bytes(counters[IFACE_TX_BYTES], tx_bytes_str, sizeof(tx_bytes_str));
+
+    if (row->rates) {
+        format_rate(row->rate[IFACE_RX_BYTES], rx_rate_str, sizeof(rx_rate_str));
+        format_rate(row->rate[IFACE_TX_BYTES], tx_rate_str, sizeof(tx_rate_str));
+    }
+
+    char *p = out->buf + out->len;
+    p = put_left(p, timestamp, (size_t)out->timestamp_width);
+    *p++ = ' ';
+    p = put_left(p, row->interface, 10);
+    *p++ = ' ';
+    p = put_right(p, rx_bytes_str, 15);
+    *p++ = ' ';
+    p = put_right(p, rx_rate_str, 12);
+    *p++ = ' ';
+    p = put_u64(p, counters[IFACE_RX_PACKETS], 10);
+    *p++ = ' ';
+    p = row->rates ? put_rate0(p, row->rate[IFACE_RX_PACKETS], 10) : put_right(p, "-", 10);
+    *p++ = ' ';
+    p = put_u64(p, counters[IFACE_RX_ERRORS], 8);
+    *p++ = ' ';
+    p = put_u64(p, counters[IFACE_RX_DROPS], 8);
+    *p++ = ' ';
+    p = put_right(p, tx_bytes_str, 15);
+    *p++ = ' ';
+    p = put_right(p, tx_rate_str, 12);
+    *p++ = ' ';
+    p = put_u64(p, counters[IFACE_TX_PACKETS], 10);
+    *p++ = ' ';
+    p = row->rates ? put_rate0(p, row->rate[IFACE_TX_PACKETS], 10) : put_right(p, "-", 10);
+    *p++ = ' ';
+    p = put_u64(p, counters[IFACE_TX_ERRORS], 8);
+    *p++ = ' ';
+    p = put_u64(p, counters[IFACE_TX_DROPS], 8);
+    *p++ = '\n';
+    out->len = (size_t)(p - out->buf);
+}
+
+/**
+ * Render one statistics row; previous may be NULL for the first sample
+ */
+void output_stats_row(output_t *out, const char *timestamp, const net_stats_t *current,
+                      const net_stats_t *previous, double elapsed) {
+    output_row_t row;
+    row_from_stats(&row, current, previous, elapsed);
+    render_stats_row(out, timestamp, &row);
+}
+
+/**
+ * Render one slot of a table whose deltas and rates iface_soa_compute()
+ * has already filled in
+ */
+void output_stats_view_row(output_t *out, const char *timestamp, const iface_soa_t *view,
+                           size_t id) {
+    output_row_t row;
+    row_from_view(&row, view, id);
+    render_stats_row(out, timestamp, &row);
+}
+
+/**
+ * Render the min, mean and peak sub-interval rates of one reporting interval
+ */
+void output_burst_row(output_t *out, const char *timestamp, const char *interface,
+                      const burst_stats_t *burst) {
+    const burst_range_t *bytes[2] = {&burst->rx_bytes, &burst->tx_bytes};
+    const burst_range_t *packets[2] = {&burst->rx_packets, &burst->tx_packets};
+
+    output_reserve(out);
+
+    char *p = out->buf + out->len;
+    p = put_left(p, timestamp, (size_t)out->timestamp_width);
+    *p++ = ' ';
+    p = put_left(p, interface, 10);
+
+    for (int dir = 0; dir < 2; dir++) {
+        char rate[32];
+        format_rate(bytes[dir]->min, rate, sizeof(rate));
+        *p++ = ' ';
+        p = put_right(p, rate, 12);
+        format_rate(burst_mean(bytes[dir], burst->count), rate, sizeof(rate));
+        *p++ = ' ';
+        p = put_right(p, rate, 12);
+        format_rate(bytes[dir]->max, rate, sizeof(rate));
+        *p++ = ' ';
+        p = put_right(p, rate, 12);
+        *p++ = ' ';
+        p = put_rate0(p, packets[dir]->min, 10);
+        *p++ = ' ';
+        p = put_rate0(p, burst_mean(packets[dir], burst->count), 10);
+        *p++ = ' ';
+        p = put_rate0(p, packets[dir]->max, 10);
+    }
+    *p++ = '\n';
+    out->len = (size_t)(p - out->buf);
+}
+
+/* JSON Lines encoder; the same unchecked appenders, with no stdio */
+
+#define PUT_LITERAL(p, s) put_str((p), (s), sizeof(s) - 1)
+
+/**
+ * Append s as a JSON string, escaping quotes, backslashes and control bytes
+ * Interface names are bytes, not necessarily UTF-8, so bytes above 0x7f
+ * are escaped as \u0080-\u00ff too and the line stays valid JSON
+ */
+static inline char *put_json_string(char *p, const char *s) {
+    static const char hex[] = "0123456789abcdef";
+    *p++ = '"';
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            *p++ = '\\';
+            *p++ = (char)c;
+        } else if (c < 0x20 || c >= 0x80) {
+            p = PUT_LITERAL(p, "\\u00");
+            *p++ = hex[c >> 4];
+            *p++ = hex[c & 15];
+        } else {
+            *p++ = (char)c;
+        }
+    }
+    *p++ = '"';
+    return p;
+}
+
+/**
+ * Append a non-negative value with three decimals; JSON has no NaN or
+ * infinity, so those become null
+ */
+static inline char *put_json_fixed3(char *p, double v) {
+    if (v >= 0.0 && v < 9007199254740.0) {
+        uint64_t milli = (uint64_t)(v * 1000.0 + 0.5);
+        p = put_decimal(p, milli / 1000);
+        *p++ = '.';
+        *p++ = (char)('0' + milli / 100 % 10);
+        *p++ = (char)('0' + milli / 10 % 10);
+        *p++ = (char)('0' + milli % 10);
+        return p;
+    }
+    if (v >= 0.0 && v <= 1.7976931348623157e308) {
+        char tmp[32];
+        int n = snprintf(tmp, sizeof(tmp), "%.3e", v);
+        return put_str(p, tmp, (size_t)n);
+    }
+    return PUT_LITERAL(p, "null");
+}
+
+static inline char *put_json_time(char *p, const struct timespec *now) {
+    p = PUT_LITERAL(p, "{\"time\":");
+    p = put_decimal(p, (uint64_t)now->tv_sec);
+    *p++ = '.';
+    unsigned ms = (unsigned)(now->tv_nsec / 1000000);
+    *p++ = (char)('0' + ms / 100);
+    *p++ = (char)('0' + ms / 10 % 10);
+    *p++ = (char)('0' + ms % 10);
+    return p;
+}
+
+static void render_json_row(output_t *out, const struct timespec *now,
+                            const output_row_t *row) {
+    static const char *const counter_keys[IFACE_COUNTERS] = {
+        ",\"rx_bytes\":", ",\"rx_packets\":", ",\"rx_errors\":", ",\"rx_drops\":",
+        ",\"tx_bytes\":", ",\"tx_packets\":", ",\"tx_errors\":", ",\"tx_drops\":",
+    };
+
+    output_reserve(out);
+
+    char *p = out->buf + out->len;
+    p = put_json_time(p, now);
+    p = PUT_LITERAL(p, ",\"interface\":");
+    p = put_json_string(p, row->interface);
+    for (int i = 0; i < IFACE_COUNTERS; i++) {
+        p = put_str(p, counter_keys[i], strlen(counter_keys[i]));
+        p = put_decimal(p, row->counters[i]);
+    }
+
+    if (!row->rates) {
+        p = PUT_LITERAL(p, ",\"elapsed\":null,\"delta\":null,\"rate\":null}\n");
+        out->len = (size_t)(p - out->buf);
+        return;
+    }
+
+    p = PUT_LITERAL(p, ",\"elapsed\":");
+    p = put_json_fixed3(p, row->elapsed);
+    p = PUT_LITERAL(p, ",\"delta\":");
+    for (int i = 0; i < IFACE_COUNTERS; i++) {
+        /* Reuse the counter keys, turning the leading comma into the brace */
+        *p++ = i == 0 ? '{' : ',';
+        p = put_str(p, counter_keys[i] + 1, strlen(counter_keys[i]) - 1);
+        p = put_decimal(p, row->delta[i]);
+    }
+    p = PUT_LITERAL(p, "},\"rate\":{\"rx_bytes\":");
+    p = put_json_fixed3(p, row->rate[IFACE_RX_BYTES]);
+    p = PUT_LITERAL(p, ",\"rx_packets\":");
+    p = put_json_fixed3(p, row->rate[IFACE_RX_PACKETS]);
+    p = PUT_LITERAL(p, ",\"tx_bytes\":");
+    p = put_json_fixed3(p, row->rate[IFACE_TX_BYTES]);
+    p = PUT_LITERAL(p, ",\"tx_packets\":");
+    p = put_json_fixed3(p, row->rate[IFACE_TX_PACKETS]);
+    p = PUT_LITERAL(p, "}}\n");
+    out->len = (size_t)(p - out->buf);
+}
+
+/**
+ * Emit one JSON object with the raw counters and, once a previous sample
+ * exists, the deltas and per-second rates; otherwise those are null
+ */
+void output_json_row(output_t *out, const struct timespec *now, const net_stats_t *current,
+                     const net_stats_t *previous, double elapsed) {
+    output_row_t row;
+    row_from_stats(&row, current, previous, elapsed);
+    render_json_row(out, now, &row);
+}
+
+/**
+ * Emit one slot of a table whose deltas and rates iface_soa_compute()
+ * has already filled in
+ */
+void output_json_view_row(output_t *out, const struct timespec *now, const iface_soa_t *view,
+                          size_t id) {
+    output_row_t row;
+    row_from_view(&row, view, id);
+    render_json_row(out, now, &row);
+}
+
+static inline char *put_json_range(char *p, const burst_range_t *range, uint32_t count) {
+    p = PUT_LITERAL(p, "{\"min\":");
+    p = put_json_fixed3(p, range->min);
+    p = PUT_LITERAL(p, ",\"mean\":");
+    p = put_json_fixed3(p, burst_mean(range, count));
+    p = PUT_LITERAL(p, ",\"peak\":");
+    p = put_json_fixed3(p, range->max);
+    *p++ = '}';
+    return p;
+}
+
+/**
+ * Emit one JSON object with the min, mean and peak sub-interval rates
+ */
+void output_json_burst_row(output_t *out, const struct timespec *now, const char *interface,
+                           const burst_stats_t *burst) {
+    output_reserve(out);
+
+    char *p = out->buf + out->len;
+    p = put_json_time(p, now);
+    p = PUT_LITERAL(p, ",\"interface\":");
+    p = put_json_string(p, interface);
+    p = PUT_LITERAL(p, ",\"samples\":");
+    p = put_decimal(p, burst->count);
+    p = PUT_LITERAL(p, ",\"rate\":{\"rx_bytes\":");
+    p = put_json_range(p, &burst->rx_bytes, burst->count);
+    p = PUT_LITERAL(p, ",\"rx_packets\":");
+    p = put_json_range(p, &burst->rx_packets, burst->count);
+    p = PUT_LITERAL(p, ",\"tx_bytes\":");
+    p = put_json_range(p, &burst->tx_bytes, burst->count);
+    p = PUT_LITERAL(p, ",\"tx_packets\":");
+    p = put_json_range(p, &burst->tx_packets, burst->count);
+    p = PUT_LITERAL(p, "}}\n");
+    out->len = (size_t)(p - out->buf);
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "netstat_monitor.h"
+#include "iface_soa.h"
+#include "burst.h"
+#include "event_loop.h"
+
+#define OUTPUT_BUFFER_SIZE (64 * 1024)
+
+/* Upper bound on one rendered row or header, reserved before rendering */
+#define OUTPUT_ROW_MAX 2048
+
+/* Unwritten output beyond which whole ticks are dropped */
+#define OUTPUT_BACKLOG_MAX (1024 * 1024)
+
+/*
+ * Rows for one tick are rendered into a single preallocated buffer and
+ * handed to the kernel with one write(), bypassing stdio. Attached to an
+ * event loop, a pipe or socket is made non-blocking: what it cannot take
+ * stays at the front of the buffer and is written on EPOLLOUT
+ */
+typedef enum {
+    OUTPUT_TABLE,
+    OUTPUT_JSON,
+    OUTPUT_BINARY,
+} output_format_t;
+
+typedef struct {
+    int fd;
+    char *buf;
+    size_t len;
+    size_t capacity;
+    int timestamp_width;
+    bool failed;
+    event_source_t source;
+    event_loop_t *loop;
+    int saved_flags;
+    bool watching;
+    uint64_t dropped;
+} output_t;
+
+bool output_init(output_t *out, int fd, int timestamp_width);
+void output_free(output_t *out);
+bool output_flush(output_t *out);
+bool output_attach(output_t *out, event_loop_t *loop);
+void output_detach(output_t *out);
+bool output_grow(output_t *out);
+void output_table_header(output_t *out, bool burst);
+void output_stats_row(output_t *out, const char *timestamp, const net_stats_t *current,
+                      const net_stats_t *previous, double elapsed);
+void output_stats_view_row(output_t *out, const char *timestamp, const iface_soa_t *view,
+                           size_t id);
+void output_burst_row(output_t *out, const char *timestamp, const char *interface,
+                      const burst_stats_t *burst);
+
+void output_json_row(output_t *out, const struct timespec *now, const net_stats_t *current,
+                     const net_stats_t *previous, double elapsed);
+void output_json_view_row(output_t *out, const struct timespec *now, const iface_soa_t *view,
+                          size_t id);
+void output_json_burst_row(output_t *out, const struct timespec *now, const char *interface,
+                           const burst_stats_t *burst);
+bool output_parse_format(const char *name, output_format_t *format);
+
+/**
+ * Make room for one row, flushing early if the tick outgrows the buffer
+ * Renderers then append up to OUTPUT_ROW_MAX bytes at buf + len
+ */
+static inline void output_reserve(output_t *out) {
+    if (out->capacity - out->len < OUTPUT_ROW_MAX) {
+        output_flush(out);
+        if (out->capacity - out->len < OUTPUT_ROW_MAX) {
+            output_grow(out);
+        }
+    }
+}
+
+/**
+ * True when the sink is so far behind that the tick should not be
+ * rendered at all; the caller counts it in dropped
+ */
+static inline bool output_congested(const output_t *out) {
+    return out->len > OUTPUT_BACKLOG_MAX;
+}
+
+void format_bytes(uint64_t bytes, char *buffer, size_t bufsize);
+void format_rate(double rate, char *buffer, size_t bufsize);
+
+#endif /* OUTPUT_H */
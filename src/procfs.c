@@ -0,0 +1,336 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "procfs.h"
+
+#define MAX_LINE_LEN 1024
+#define PROC_BUF_INITIAL 16384
+
+/**
+ * Locate the interface name on a /proc/net/dev line without copying it
+ * Expected format: "  eth0: 12345 678 ..."
+ * Stores the trimmed name length, and a pointer just past the colon in fields
+ * Returns the start of the name, or NULL if the line has no colon
+ */
+const char *procfs_line_name(const char *line, size_t *name_len, const char **fields) {
+    const char *p = line;
+    while (*p == ' ' || *p == '\t') {
+        p++;
+    }
+
+    const char *name = p;
+    while (*p != ':') {
+        if (*p == '\0' || *p == '\n') {
+            return NULL;
+        }
+        p++;
+    }
+
+    const char *end = p;
+    while (end > name && (end[-1] == ' ' || end[-1] == '\t')) {
+        end--;
+    }
+
+    *name_len = (size_t)(end - name);
+    *fields = p + 1;
+    return name;
+}
+
+/**
+ * Convert the 16 decimal counters following the colon in one forward pass
+ * Only the receive/transmit bytes, packets, errors and drops are stored;
+ * stats is left untouched if any field is malformed
+ * Returns a pointer to the end of the line, or NULL on a malformed field
+ */
+const char *procfs_parse_counters(const char *fields, net_stats_t *stats) {
+    uint64_t values[PROC_NET_DEV_FIELDS];
+    const char *p = fields;
+
+    for (int i = 0; i < PROC_NET_DEV_FIELDS; i++) {
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+
+        unsigned digit = (unsigned)(*p - '0');
+        if (digit > 9) {
+            return NULL;
+        }
+
+        /* Wrapped values are caught by length and digits afterwards */
+        const char *start = p;
+        uint64_t value = 0;
+        do {
+            value = value * 10 + digit;
+            digit = (unsigned)(*++p - '0');
+        } while (digit <= 9);
+
+        if (!procfs_digits_fit(start, (size_t)(p - start))) {
+            return NULL;
+        }
+        if (!procfs_is_terminator(*p)) {
+            return NULL;
+        }
+        values[i] = value;
+    }
+
+    procfs_store_counters(stats, values);
+    return procfs_line_end(p);
+}
+
+/**
+ * Return a pointer to the newline or NUL that ends the line containing p
+ */
+const char *procfs_line_end(const char *p) {
+    const char *nl = strchr(p, '\n');
+    return nl ? nl : p + strlen(p);
+}
+
+/**
+ * Parse a single line from /proc/net/dev for the specified interface
+ * A NULL interface accepts any line; the parsed name is stored in stats
+ * Returns true if line matches interface and parsing succeeds
+ */
+bool parse_interface_line(const char *line, const char *interface, net_stats_t *stats) {
+    size_t name_len;
+    const char *fields;
+    const char *name = procfs_line_name(line, &name_len, &fields);
+    if (!name || name_len >= MAX_IFACE_LEN) {
+        return false;
+    }
+
+    if (interface && !procfs_name_matches(name, name_len, interface)) {
+        return false;
+    }
+
+    if (!procfs_parse_counters(fields, stats)) {
+        return false;
+    }
+
+    procfs_store_name(stats, name, name_len);
+    return true;
+}
+
+const procfs_scanner_t procfs_scanner_scalar = {
+    .name = "scalar",
+    .line_name = procfs_line_name,
+    .parse_counters = procfs_parse_counters,
+    .line_end = procfs_line_end,
+    .parse_line = parse_interface_line,
+};
+
+/**
+ * Prepare the /proc/net/dev reader
+ * Unless reopen is requested, the descriptor stays open for the whole run
+ */
+bool procfs_open(procfs_reader_t *reader, bool reopen) {
+    reader->fd = -1;
+    reader->reopen = reopen;
+    reader->io = (io_counters_t){0};
+    reader->scanner = procfs_scanner_get(NULL);
+    reader->bufsize = PROC_BUF_INITIAL;
+    reader->buf = malloc(reader->bufsize);
+    if (!reader->buf) {
+        fprintf(stderr, "Error: Cannot allocate read buffer: %s\n", strerror(errno));
+        return false;
+    }
+
+    if (!reopen) {
+        reader->fd = open(PROC_NET_DEV, O_RDONLY | O_CLOEXEC);
+        if (reader->fd < 0) {
+            fprintf(stderr, "Error: Cannot open %s: %s\n", PROC_NET_DEV, strerror(errno));
+            procfs_close(reader);
+            return false;
+        }
+    }
+    return true;
+}
+
+void procfs_close(procfs_reader_t *reader) {
+    if (reader->fd >= 0) {
+        close(reader->fd);
+        reader->fd = -1;
+    }
+    free(reader->buf);
+    reader->buf = NULL;
+    reader->bufsize = 0;
+}
+
+/**
+ * Read the whole of /proc/net/dev into the reader buffer, NUL-terminated
+ * Uses pread() at offset 0 on the persistent descriptor, falling back to
+ * open/read/close for the rest of the run if the kernel refuses pread
+ * Returns the number of bytes read, or -1 on error
+ */
+ssize_t procfs_read(procfs_reader_t *reader) {
+    int fd = reader->fd;
+    if (reader->reopen) {
+        fd = open(PROC_NET_DEV, O_RDONLY | O_CLOEXEC);
+        reader->io.syscalls++;
+        if (fd < 0) {
+            fprintf(stderr, "Error: Cannot open %s: %s\n", PROC_NET_DEV, strerror(errno));
+            return -1;
+        }
+    }
+
+    size_t len = 0;
+    for (;;) {
+        if (len + 1 >= reader->bufsize) {
+            char *buf = realloc(reader->buf, reader->bufsize * 2);
+            if (!buf) {
+                fprintf(stderr, "Error: Cannot grow read buffer: %s\n", strerror(errno));
+                break;
+            }
+            reader->buf = buf;
+            reader->bufsize *= 2;
+        }
+
+        ssize_t n = reader->reopen
+            ? read(fd, reader->buf + len, reader->bufsize - len - 1)
+            : pread(fd, reader->buf + len, reader->bufsize - len - 1, (off_t)len);
+        reader->io.syscalls++;
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && !reader->reopen) {
+            fprintf(stderr, "Warning: pread on %s failed (%s), reopening per sample\n",
+                    PROC_NET_DEV, strerror(errno));
+            close(reader->fd);
+            reader->fd = -1;
+            reader->reopen = true;
+            return procfs_read(reader);
+        }
+        if (n <= 0) {
+            if (n < 0) {
+                fprintf(stderr, "Error: Cannot read %s: %s\n", PROC_NET_DEV, strerror(errno));
+            }
+            break;
+        }
+        len += (size_t)n;
+        reader->io.bytes += (uint64_t)n;
+    }
+
+    if (reader->reopen) {
+        close(fd);
+        reader->io.syscalls++;
+    }
+
+    reader->buf[len] = '\0';
+    return len > 0 ? (ssize_t)len : -1;
+}
+
+/**
+ * Fill the table from a NUL-terminated copy of /proc/net/dev
+ * Lines for unwatched interfaces are rejected on the name alone, without
+ * copying or converting anything
+ * In watch-all mode, interfaces seen for the first time are appended if the
+ * table's filter selects them
+ */
+void procfs_parse_buffer(const procfs_scanner_t *scanner, const char *buf, iface_table_t *table) {
+    iface_table_begin_sample(table);
+
+    /* Skip the two header lines */
+    const char *line = buf;
+    for (int i = 0; i < 2 && *line; i++) {
+        line = scanner->line_end(line);
+        if (*line) {
+            line++;
+        }
+    }
+
+    while (*line) {
+        size_t name_len;
+        const char *fields;
+        const char *name = scanner->line_name(line, &name_len, &fields);
+        const char *eol = NULL;
+
+        if (name) {
+            iface_slot_t *slot = iface_table_discover(table, name, name_len);
+            if (slot) {
+                eol = scanner->parse_counters(fields, &slot->current);
+                slot->seen = (eol != NULL);
+            }
+        }
+
+        if (!eol) {
+            eol = scanner->line_end(name ? fields : line);
+        }
+        line = *eol ? eol + 1 : eol;
+    }
+}
+
+/**
+ * Read statistics for every watched interface from one pass over /proc/net/dev
+ * Returns true on success, false if the file cannot be read
+ */
+bool read_net_stats(procfs_reader_t *reader, iface_table_t *table) {
+    if (procfs_read(reader) < 0) {
+        return false;
+    }
+
+    procfs_parse_buffer(reader->scanner, reader->buf, table);
+
+    /* One timestamp per pass: every interface was sampled from the same read */
+    iface_table_stamp(table);
+
+    return true;
+}
+
+/**
+ * List interface names found in /proc/net/dev on stderr
+ */
+void print_available_interfaces(void) {
+    fprintf(stderr, "Available interfaces:\n");
+
+    FILE *fp = fopen(PROC_NET_DEV, "r");
+    if (!fp) {
+        return;
+    }
+
+    char line[MAX_LINE_LEN];
+    int line_num = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        line_num++;
+        if (line_num <= 2) continue;
+
+        char *colon = strchr(line, ':');
+        if (colon) {
+            *colon = '\0';
+            const char *iface = line;
+            while (*iface == ' ' || *iface == '\t') iface++;
+
+            char iface_trimmed[MAX_IFACE_LEN];
+            strncpy(iface_trimmed, iface, sizeof(iface_trimmed) - 1);
+            iface_trimmed[sizeof(iface_trimmed) - 1] = '\0';
+
+            size_t len = strlen(iface_trimmed);
+            while (len > 0 && (iface_trimmed[len - 1] == ' ' || iface_trimmed[len - 1] == '\t')) {
+                iface_trimmed[--len] = '\0';
+            }
+
+            fprintf(stderr, "  %s\n", iface_trimmed);
+        }
+    }
+    fclose(fp);
+}
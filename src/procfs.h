@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef PROCFS_H
+#define PROCFS_H
+
+#include <stddef.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "netstat_monitor.h"
+#include "iface_table.h"
+
+#define PROC_NET_DEV_FIELDS 16
+
+/*
+ * A /proc/net/dev line scanner. The scalar implementation is always
+ * available; SIMD variants with the same contract are picked at runtime
+ * by procfs_scanner_get()
+ */
+typedef struct {
+    const char *name;
+    const char *(*line_name)(const char *line, size_t *name_len, const char **fields);
+    const char *(*parse_counters)(const char *fields, net_stats_t *stats);
+    const char *(*line_end)(const char *p);
+    bool (*parse_line)(const char *line, const char *interface, net_stats_t *stats);
+} procfs_scanner_t;
+
+typedef struct {
+    int fd;
+    char *buf;
+    size_t bufsize;
+    bool reopen;
+    const procfs_scanner_t *scanner;
+    io_counters_t io;
+} procfs_reader_t;
+
+extern const procfs_scanner_t procfs_scanner_scalar;
+
+bool procfs_open(procfs_reader_t *reader, bool reopen);
+void procfs_close(procfs_reader_t *reader);
+ssize_t procfs_read(procfs_reader_t *reader);
+bool read_net_stats(procfs_reader_t *reader, iface_table_t *table);
+void procfs_parse_buffer(const procfs_scanner_t *scanner, const char *buf, iface_table_t *table);
+void print_available_interfaces(void);
+
+const char *procfs_line_name(const char *line, size_t *name_len, const char **fields);
+const char *procfs_parse_counters(const char *fields, net_stats_t *stats);
+const char *procfs_line_end(const char *p);
+bool parse_interface_line(const char *line, const char *interface, net_stats_t *stats);
+
+const procfs_scanner_t *procfs_scanner_get(const char *name);
+
+/* Helpers shared by the scanner implementations */
+
+static inline bool procfs_name_matches(const char *name, size_t name_len, const char *interface) {
+    for (size_t i = 0; i < name_len; i++) {
+        if (interface[i] != name[i]) {
+            return false;
+        }
+    }
+    return interface[name_len] == '\0';
+}
+
+static inline void procfs_store_name(net_stats_t *stats, const char *name, size_t name_len) {
+    for (size_t i = 0; i < name_len; i++) {
+        stats->interface[i] = name[i];
+    }
+    stats->interface[name_len] = '\0';
+}
+
+static inline bool procfs_is_terminator(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\0';
+}
+
+/**
+ * True if a run of len decimal digits fits a uint64_t, as strtoull() would
+ * accept it. Only a 20-digit run needs a look at the digits themselves
+ */
+static inline bool procfs_digits_fit(const char *digits, size_t len) {
+    return len < 20 || (len == 20 && memcmp(digits, "18446744073709551615", 20) <= 0);
+}
+
+static inline void procfs_store_counters(net_stats_t *stats, const uint64_t *values) {
+    stats->rx_bytes = values[0];
+    stats->rx_packets = values[1];
+    stats->rx_errors = values[2];
+    stats->rx_drops = values[3];
+    stats->tx_bytes = values[8];
+    stats->tx_packets = values[9];
+    stats->tx_errors = values[10];
+    stats->tx_drops = values[11];
+    stats->valid = true;
+}
+
+#endif /* PROCFS_H */
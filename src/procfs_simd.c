@@ -0,0 +1,482 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <stdint.h>
+
+#include "procfs.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PROCFS_HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+#ifdef PROCFS_HAVE_X86
+
+/*
+ * Vector loads may run past the end of the line. Like the string functions
+ * in libc, a load is only issued when it cannot cross into the next page;
+ * otherwise the scanners fall back to one byte at a time
+ */
+#define SCAN_PAGE_SIZE 4096
+#define SCAN_WINDOW 64
+
+static inline bool load_is_safe(const char *p, size_t width) {
+    return ((uintptr_t)p & (SCAN_PAGE_SIZE - 1)) <= SCAN_PAGE_SIZE - width;
+}
+
+static inline uint64_t low_bits(unsigned n) {
+    return n >= 64 ? ~UINT64_C(0) : (UINT64_C(1) << n) - 1;
+}
+
+/**
+ * Convert one field at p the slow way, for windows that end near a page
+ * boundary. Returns a pointer past the digits, or NULL if malformed
+ */
+static const char *scalar_field(const char *p, uint64_t *value) {
+    while (*p == ' ' || *p == '\t') {
+        p++;
+    }
+    const char *start = p;
+    uint64_t v = 0;
+    while ((unsigned)(*p - '0') <= 9) {
+        v = v * 10 + (unsigned)(*p - '0');
+        p++;
+    }
+    if (p == start || !procfs_digits_fit(start, (size_t)(p - start)) ||
+        !procfs_is_terminator(*p)) {
+        return NULL;
+    }
+    *value = v;
+    return p;
+}
+
+/**
+ * Locate the digit runs that lie entirely inside one 64-byte window, given
+ * its digit and blank masks. Up to want runs are stored as start/length
+ * pairs; consumed is set to where the next window should begin, which is
+ * the start of a run that crosses the window edge
+ * Returns the number of runs found, or -1 if the window is malformed
+ */
+static inline int window_runs(const char *p, uint64_t digit, uint64_t blank, int want,
+                              uint8_t *starts, uint8_t *lens, unsigned *consumed) {
+    uint64_t other = ~(digit | blank);
+    uint64_t run_starts = digit & ~(digit << 1);
+    uint64_t run_ends = ~digit & (digit << 1);
+    unsigned pos = 0;
+    int n = 0;
+
+    while (n < want && run_starts) {
+        unsigned s = (unsigned)__builtin_ctzll(run_starts);
+        if (other & low_bits(s) & ~low_bits(pos)) {
+            return -1;
+        }
+
+        uint64_t after = run_ends & ~low_bits(s);
+        if (!after) {
+            if (s == 0) {
+                return -1;
+            }
+            *consumed = s;
+            return n;
+        }
+
+        unsigned e = (unsigned)__builtin_ctzll(after);
+        if (!procfs_digits_fit(p + s, e - s) || !procfs_is_terminator(p[e])) {
+            return -1;
+        }
+        starts[n] = (uint8_t)s;
+        lens[n] = (uint8_t)(e - s);
+        n++;
+        pos = e;
+        run_starts &= run_starts - 1;
+    }
+
+    if (n < want && (other & ~low_bits(pos))) {
+        /* The line ended before every field was seen */
+        return -1;
+    }
+    *consumed = n < want ? SCAN_WINDOW : pos;
+    return n;
+}
+
+static const uint64_t pow10_16 = UINT64_C(10000000000000000);
+
+static inline uint64_t scalar_digits(const char *p, size_t len) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < len; i++) {
+        value = value * 10 + (unsigned)(p[i] - '0');
+    }
+    return value;
+}
+
+/**
+ * Convert n (1..8) ASCII digits at p, with 8 bytes readable, in a few
+ * 64-bit multiplies. Bytes past the digits borrow only into higher bytes,
+ * which the shift discards
+ */
+static inline uint64_t swar_digits(const char *p, size_t n) {
+    uint64_t x;
+    memcpy(&x, p, sizeof(x));
+    x -= UINT64_C(0x3030303030303030);
+    x <<= 8 * (8 - n);
+    x = x * 10 + (x >> 8);
+    x = (((x & UINT64_C(0x000000FF000000FF)) * UINT64_C(0x000F424000000064)) +
+         (((x >> 16) & UINT64_C(0x000000FF000000FF)) * UINT64_C(0x0000271000000001))) >> 32;
+    return x;
+}
+
+/**
+ * Convert a run of 1..20 digits eight at a time
+ */
+static inline uint64_t swar_digits_to_u64(const char *p, size_t len) {
+    if (!load_is_safe(p, len > 8 ? len : 8)) {
+        return scalar_digits(p, len);
+    }
+
+    uint64_t value = 0;
+    size_t head = len & 7;
+    if (head) {
+        value = swar_digits(p, head);
+        p += head;
+    }
+    for (size_t chunks = len >> 3; chunks; chunks--) {
+        value = value * 100000000 + swar_digits(p, 8);
+        p += 8;
+    }
+    return value;
+}
+
+static inline const char *name_bounds(const char *name, const char *colon,
+                                      size_t *name_len, const char **fields) {
+    if (*colon != ':') {
+        return NULL;
+    }
+    const char *end = colon;
+    while (end > name && (end[-1] == ' ' || end[-1] == '\t')) {
+        end--;
+    }
+    *name_len = (size_t)(end - name);
+    *fields = colon + 1;
+    return name;
+}
+
+/* ---- SSE2: 16-byte classification, SWAR conversion ---- */
+
+__attribute__((target("sse2")))
+static inline uint32_t sse2_mask_eq(__m128i v, char c) {
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c)));
+}
+
+__attribute__((target("sse2")))
+static inline uint32_t sse2_mask_digit(__m128i v) {
+    __m128i ge = _mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1));
+    __m128i le = _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1));
+    return (uint32_t)_mm_movemask_epi8(_mm_and_si128(ge, le));
+}
+
+__attribute__((target("sse2")))
+static inline const char *sse2_skip_blanks(const char *p) {
+    while (load_is_safe(p, 16)) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(const void *)p);
+        uint32_t other = ~(sse2_mask_eq(v, ' ') | sse2_mask_eq(v, '\t')) & 0xFFFF;
+        if (other) {
+            return p + __builtin_ctz(other);
+        }
+        p += 16;
+    }
+    while (*p == ' ' || *p == '\t') {
+        p++;
+    }
+    return p;
+}
+
+/**
+ * Return a pointer to the first byte at or after p that is a, b or NUL
+ */
+__attribute__((target("sse2")))
+static inline const char *sse2_find2(const char *p, char a, char b) {
+    while (load_is_safe(p, 16)) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(const void *)p);
+        uint32_t hit = sse2_mask_eq(v, a) | sse2_mask_eq(v, b) | sse2_mask_eq(v, '\0');
+        if (hit) {
+            return p + __builtin_ctz(hit);
+        }
+        p += 16;
+    }
+    while (*p != a && *p != b && *p != '\0') {
+        p++;
+    }
+    return p;
+}
+
+__attribute__((target("sse2")))
+static const char *sse2_line_name(const char *line, size_t *name_len, const char **fields) {
+    const char *name = sse2_skip_blanks(line);
+    return name_bounds(name, sse2_find2(name, ':', '\n'), name_len, fields);
+}
+
+__attribute__((target("sse2")))
+static const char *sse2_parse_counters(const char *fields, net_stats_t *stats) {
+    uint64_t values[PROC_NET_DEV_FIELDS];
+    uint8_t starts[PROC_NET_DEV_FIELDS], lens[PROC_NET_DEV_FIELDS];
+    const char *p = fields;
+    int field = 0;
+
+    while (field < PROC_NET_DEV_FIELDS) {
+        if (!load_is_safe(p, SCAN_WINDOW)) {
+            p = scalar_field(p, &values[field++]);
+            if (!p) {
+                return NULL;
+            }
+            continue;
+        }
+
+        uint64_t digit = 0, blank = 0;
+        for (int k = 0; k < SCAN_WINDOW / 16; k++) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(const void *)(p + 16 * k));
+            digit |= (uint64_t)sse2_mask_digit(v) << (16 * k);
+            blank |= (uint64_t)(sse2_mask_eq(v, ' ') | sse2_mask_eq(v, '\t')) << (16 * k);
+        }
+
+        unsigned consumed;
+        int n = window_runs(p, digit, blank, PROC_NET_DEV_FIELDS - field, starts, lens, &consumed);
+        if (n < 0) {
+            return NULL;
+        }
+        for (int k = 0; k < n; k++) {
+            values[field++] = swar_digits_to_u64(p + starts[k], lens[k]);
+        }
+        p += consumed;
+    }
+
+    procfs_store_counters(stats, values);
+    return procfs_line_end(p);
+}
+
+__attribute__((target("sse2")))
+static bool sse2_parse_line(const char *line, const char *interface, net_stats_t *stats) {
+    size_t name_len;
+    const char *fields;
+    const char *name = sse2_line_name(line, &name_len, &fields);
+    if (!name || name_len >= MAX_IFACE_LEN) {
+        return false;
+    }
+    if (interface && !procfs_name_matches(name, name_len, interface)) {
+        return false;
+    }
+    if (!sse2_parse_counters(fields, stats)) {
+        return false;
+    }
+    procfs_store_name(stats, name, name_len);
+    return true;
+}
+
+static const procfs_scanner_t procfs_scanner_sse2 = {
+    .name = "sse2",
+    .line_name = sse2_line_name,
+    .parse_counters = sse2_parse_counters,
+    .line_end = procfs_line_end,
+    .parse_line = sse2_parse_line,
+};
+
+/* ---- AVX2: 32-byte classification, 16-digit vector conversion ---- */
+
+/*
+ * Sliding window of pshufb indices: loading 16 bytes at offset len moves
+ * the first len bytes of a vector to its end and zeroes the rest
+ */
+static const int8_t align_window[32] = {
+    -128, -128, -128, -128, -128, -128, -128, -128,
+    -128, -128, -128, -128, -128, -128, -128, -128,
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+};
+
+__attribute__((target("avx2")))
+static inline uint32_t avx2_mask_eq(__m256i v, char c) {
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c)));
+}
+
+__attribute__((target("avx2")))
+static inline uint32_t avx2_mask_digit(__m256i v) {
+    __m256i ge = _mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1));
+    __m256i le = _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v);
+    return (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(ge, le));
+}
+
+__attribute__((target("avx2")))
+static inline const char *avx2_skip_blanks(const char *p) {
+    while (load_is_safe(p, 32)) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(const void *)p);
+        uint32_t other = ~(avx2_mask_eq(v, ' ') | avx2_mask_eq(v, '\t'));
+        if (other) {
+            return p + __builtin_ctz(other);
+        }
+        p += 32;
+    }
+    while (*p == ' ' || *p == '\t') {
+        p++;
+    }
+    return p;
+}
+
+__attribute__((target("avx2")))
+static inline const char *avx2_find2(const char *p, char a, char b) {
+    while (load_is_safe(p, 32)) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(const void *)p);
+        uint32_t hit = avx2_mask_eq(v, a) | avx2_mask_eq(v, b) | avx2_mask_eq(v, '\0');
+        if (hit) {
+            return p + __builtin_ctz(hit);
+        }
+        p += 32;
+    }
+    while (*p != a && *p != b && *p != '\0') {
+        p++;
+    }
+    return p;
+}
+
+/**
+ * Convert up to 16 digits at p, with 16 bytes readable: right-align them
+ * with pshufb, then combine pairs, quads and octets with multiply-adds
+ */
+__attribute__((target("avx2")))
+static inline uint64_t avx2_digits16(const char *p, size_t len) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(const void *)p);
+    v = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+    v = _mm_shuffle_epi8(v, _mm_loadu_si128((const __m128i *)(const void *)(align_window + len)));
+    v = _mm_maddubs_epi16(v, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1,
+                                           10, 1, 10, 1, 10, 1, 10, 1));
+    v = _mm_madd_epi16(v, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+    v = _mm_packus_epi32(v, v);
+    v = _mm_madd_epi16(v, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+
+    uint64_t high = (uint32_t)_mm_cvtsi128_si32(v);
+    uint64_t low = (uint32_t)_mm_extract_epi32(v, 1);
+    return high * 100000000 + low;
+}
+
+__attribute__((target("avx2")))
+static inline uint64_t avx2_digits_to_u64(const char *p, size_t len) {
+    if (len > 16) {
+        size_t head = len - 16;
+        if (!load_is_safe(p + head, 16)) {
+            return scalar_digits(p, len);
+        }
+        return scalar_digits(p, head) * pow10_16 + avx2_digits16(p + head, 16);
+    }
+    if (!load_is_safe(p, 16)) {
+        return scalar_digits(p, len);
+    }
+    return avx2_digits16(p, len);
+}
+
+__attribute__((target("avx2")))
+static const char *avx2_line_name(const char *line, size_t *name_len, const char **fields) {
+    const char *name = avx2_skip_blanks(line);
+    return name_bounds(name, avx2_find2(name, ':', '\n'), name_len, fields);
+}
+
+__attribute__((target("avx2")))
+static const char *avx2_parse_counters(const char *fields, net_stats_t *stats) {
+    uint64_t values[PROC_NET_DEV_FIELDS];
+    uint8_t starts[PROC_NET_DEV_FIELDS], lens[PROC_NET_DEV_FIELDS];
+    const char *p = fields;
+    int field = 0;
+
+    while (field < PROC_NET_DEV_FIELDS) {
+        if (!load_is_safe(p, SCAN_WINDOW)) {
+            p = scalar_field(p, &values[field++]);
+            if (!p) {
+                return NULL;
+            }
+            continue;
+        }
+
+        __m256i lo = _mm256_loadu_si256((const __m256i *)(const void *)p);
+        __m256i hi = _mm256_loadu_si256((const __m256i *)(const void *)(p + 32));
+        uint64_t digit = avx2_mask_digit(lo) | (uint64_t)avx2_mask_digit(hi) << 32;
+        uint64_t blank = (avx2_mask_eq(lo, ' ') | avx2_mask_eq(lo, '\t')) |
+                         (uint64_t)(avx2_mask_eq(hi, ' ') | avx2_mask_eq(hi, '\t')) << 32;
+
+        unsigned consumed;
+        int n = window_runs(p, digit, blank, PROC_NET_DEV_FIELDS - field, starts, lens, &consumed);
+        if (n < 0) {
+            return NULL;
+        }
+        for (int k = 0; k < n; k++) {
+            values[field++] = avx2_digits_to_u64(p + starts[k], lens[k]);
+        }
+        p += consumed;
+    }
+
+    procfs_store_counters(stats, values);
+    return procfs_line_end(p);
+}
+
+__attribute__((target("avx2")))
+static bool avx2_parse_line(const char *line, const char *interface, net_stats_t *stats) {
+    size_t name_len;
+    const char *fields;
+    const char *name = avx2_line_name(line, &name_len, &fields);
+    if (!name || name_len >= MAX_IFACE_LEN) {
+        return false;
+    }
+    if (interface && !procfs_name_matches(name, name_len, interface)) {
+        return false;
+    }
+    if (!avx2_parse_counters(fields, stats)) {
+        return false;
+    }
+    procfs_store_name(stats, name, name_len);
+    return true;
+}
+
+static const procfs_scanner_t procfs_scanner_avx2 = {
+    .name = "avx2",
+    .line_name = avx2_line_name,
+    .parse_counters = avx2_parse_counters,
+    .line_end = procfs_line_end,
+    .parse_line = avx2_parse_line,
+};
+
+#endif /* PROCFS_HAVE_X86 */
+
+/**
+ * Look up a scanner by name ("scalar", "sse2", "avx2")
+ * NULL or "auto" selects the fastest one the CPU supports
+ * Returns NULL if the name is unknown or the CPU lacks the instructions
+ */
+const procfs_scanner_t *procfs_scanner_get(const char *name) {
+    bool pick_best = !name || strcmp(name, "auto") == 0;
+
+#ifdef PROCFS_HAVE_X86
+    __builtin_cpu_init();
+    if ((pick_best || strcmp(name, "avx2") == 0) && __builtin_cpu_supports("avx2")) {
+        return &procfs_scanner_avx2;
+    }
+    if ((pick_best || strcmp(name, "sse2") == 0) && __builtin_cpu_supports("sse2")) {
+        return &procfs_scanner_sse2;
+    }
+#endif
+
+    if (pick_best || strcmp(name, "scalar") == 0) {
+        return &procfs_scanner_scalar;
+    }
+    return NULL;
+}
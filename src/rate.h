@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef RATE_H
+#define RATE_H
+
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * Calculate time difference in seconds between two timespec structures
+ */
+static inline double timespec_diff(const struct timespec *start, const struct timespec *end) {
+    double diff = (end->tv_sec - start->tv_sec);
+    diff += (end->tv_nsec - start->tv_nsec) / 1e9;
+    return diff;
+}
+
+/**
+ * Safely compute delta between two counter values, handling wraparound
+ * Assumes 64-bit counters, but handles 32-bit wraparound gracefully
+ */
+static inline uint64_t safe_delta(uint64_t current, uint64_t previous) {
+    if (current >= previous) {
+        return current - previous;
+    }
+    /* Counter wrapped around - assume 32-bit wraparound */
+    return (UINT64_C(0x100000000) - previous) + current;
+}
+
+/**
+ * Calculate rate per second from delta and elapsed time
+ */
+static inline double calculate_rate(uint64_t delta, double elapsed_seconds) {
+    if (elapsed_seconds <= 0.0) {
+        return 0.0;
+    }
+    return (double)delta / elapsed_seconds;
+}
+
+#endif /* RATE_H */
@@ -0,0 +1,349 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "record.h"
+#include "timestamp.h"
+#include "rate.h"
+
+static inline uint8_t *put_le16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static inline uint8_t *put_le64(uint8_t *p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+    return p + 8;
+}
+
+static inline uint64_t get_le64(const uint8_t *p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) {
+        v = v << 8 | p[i];
+    }
+    return v;
+}
+
+static inline uint8_t *put_varint(uint8_t *p, uint64_t v) {
+    while (v >= 0x80) {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+/* Small changes in either direction encode to small varints */
+static inline uint64_t zigzag(uint64_t delta) {
+    return (delta << 1) ^ (uint64_t)-(int64_t)(delta >> 63);
+}
+
+static inline uint64_t unzigzag(uint64_t v) {
+    return (v >> 1) ^ (uint64_t)-(int64_t)(v & 1);
+}
+
+static inline uint64_t timespec_ns(const struct timespec *ts) {
+    return (uint64_t)ts->tv_sec * NSEC_PER_SEC + (uint64_t)ts->tv_nsec;
+}
+
+static inline void stats_counters(const net_stats_t *stats, uint64_t *counters) {
+    counters[0] = stats->rx_bytes;
+    counters[1] = stats->rx_packets;
+    counters[2] = stats->rx_errors;
+    counters[3] = stats->rx_drops;
+    counters[4] = stats->tx_bytes;
+    counters[5] = stats->tx_packets;
+    counters[6] = stats->tx_errors;
+    counters[7] = stats->tx_drops;
+}
+
+static inline void counters_stats(const uint64_t *counters, net_stats_t *stats) {
+    stats->rx_bytes = counters[0];
+    stats->rx_packets = counters[1];
+    stats->rx_errors = counters[2];
+    stats->rx_drops = counters[3];
+    stats->tx_bytes = counters[4];
+    stats->tx_packets = counters[5];
+    stats->tx_errors = counters[6];
+    stats->tx_drops = counters[7];
+}
+
+/**
+ * Make sure state has an entry for id; entries only grow when a new
+ * interface first appears. Ids come from files too, so they are bounded
+ * by RECORD_MAX_ID before anything is allocated
+ */
+static bool state_reserve(record_state_t *state, size_t id) {
+    if (id < state->capacity) {
+        return true;
+    }
+    if (id > RECORD_MAX_ID) {
+        return false;
+    }
+    size_t capacity = state->capacity ? state->capacity : 8;
+    while (capacity <= id) {
+        capacity *= 2;
+    }
+    record_iface_t *ifaces = realloc(state->ifaces, capacity * sizeof(*ifaces));
+    if (!ifaces) {
+        fprintf(stderr, "Error: Cannot grow record state: %s\n", strerror(errno));
+        return false;
+    }
+    memset(ifaces + state->capacity, 0, (capacity - state->capacity) * sizeof(*ifaces));
+    state->ifaces = ifaces;
+    state->capacity = capacity;
+    return true;
+}
+
+void record_state_free(record_state_t *state) {
+    free(state->ifaces);
+    memset(state, 0, sizeof(*state));
+}
+
+void record_write_header(record_state_t *state, output_t *out, uint64_t interval_ns,
+                         const struct timespec *start) {
+    output_reserve(out);
+
+    uint8_t *p = (uint8_t *)out->buf + out->len;
+    memcpy(p, RECORD_MAGIC, 4);
+    p = put_le16(p + 4, RECORD_VERSION);
+    p = put_le16(p, RECORD_HEADER_SIZE);
+    p = put_le64(p, interval_ns);
+    p = put_le64(p, timespec_ns(start));
+    p = put_le64(p, 0);
+    out->len = (size_t)((char *)p - out->buf);
+    state->last_ns = timespec_ns(start);
+}
+
+/**
+ * Append one sample record, preceded by the interface's name the first
+ * time its id is seen
+ * Returns false if id exceeds RECORD_MAX_ID or the per-interface state
+ * cannot grow
+ */
+bool record_write_sample(record_state_t *state, output_t *out, size_t id,
+                         const struct timespec *wall, const net_stats_t *stats) {
+    uint64_t counters[RECORD_COUNTERS];
+    uint64_t now = timespec_ns(wall);
+
+    if (!state_reserve(state, id)) {
+        return false;
+    }
+    record_iface_t *iface = &state->ifaces[id];
+
+    output_reserve(out);
+    uint8_t *p = (uint8_t *)out->buf + out->len;
+
+    if (!iface->defined) {
+        size_t len = strlen(stats->interface);
+        *p++ = RECORD_IFACE;
+        p = put_varint(p, id);
+        *p++ = (uint8_t)len;
+        memcpy(p, stats->interface, len);
+        p += len;
+        iface->defined = true;
+    }
+
+    stats_counters(stats, counters);
+    *p++ = RECORD_SAMPLE;
+    p = put_varint(p, id);
+    p = put_varint(p, zigzag(now - state->last_ns));
+    for (int i = 0; i < RECORD_COUNTERS; i++) {
+        p = put_varint(p, zigzag(counters[i] - iface->counters[i]));
+        iface->counters[i] = counters[i];
+    }
+    state->last_ns = now;
+
+    out->len = (size_t)((char *)p - out->buf);
+    return true;
+}
+
+void record_write_gone(record_state_t *state, output_t *out, size_t id) {
+    if (id >= state->capacity || !state->ifaces[id].defined) {
+        return;
+    }
+    output_reserve(out);
+    uint8_t *p = (uint8_t *)out->buf + out->len;
+    *p++ = RECORD_GONE;
+    p = put_varint(p, id);
+    out->len = (size_t)((char *)p - out->buf);
+}
+
+/**
+ * Have the next sample of id name the interface again, keeping its baseline
+ */
+void record_rename(record_state_t *state, size_t id) {
+    if (id < state->capacity) {
+        state->ifaces[id].defined = false;
+    }
+}
+
+/* Decoder */
+
+static bool read_varint(FILE *fp, uint64_t *value) {
+    uint64_t v = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        int c = getc_unlocked(fp);
+        if (c == EOF) {
+            return false;
+        }
+        v |= (uint64_t)(c & 0x7f) << shift;
+        if (!(c & 0x80)) {
+            *value = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Convert a capture back to the table or JSON Lines on stdout
+ */
+bool record_decode(const char *path, output_format_t format) {
+    uint8_t header[RECORD_HEADER_SIZE];
+    record_state_t state = {0};
+    char (*names)[MAX_IFACE_LEN] = NULL;
+    size_t names_capacity = 0;
+    timestamp_cache_t clock;
+    output_t out = {0};
+    bool ok = false;
+
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        fprintf(stderr, "Error: Cannot open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    if (fread(header, 1, sizeof(header), fp) != sizeof(header) ||
+        memcmp(header, RECORD_MAGIC, 4) != 0 || header[4] != RECORD_VERSION || header[5] != 0) {
+        fprintf(stderr, "Error: %s is not a netstat_monitor binary capture\n", path);
+        goto out;
+    }
+    size_t header_size = (size_t)header[6] | (size_t)header[7] << 8;
+    if (header_size < RECORD_HEADER_SIZE || fseek(fp, (long)header_size, SEEK_SET) != 0) {
+        fprintf(stderr, "Error: %s has a malformed header\n", path);
+        goto out;
+    }
+    uint64_t interval_ns = get_le64(header + 8);
+    state.last_ns = get_le64(header + 16);
+
+    timestamp_cache_init(&clock, interval_ns < NSEC_PER_SEC);
+    if (!output_init(&out, STDOUT_FILENO, timestamp_width(&clock))) {
+        goto out;
+    }
+    if (format == OUTPUT_TABLE) {
+        output_table_header(&out, false);
+    }
+
+    for (;;) {
+        int tag = getc_unlocked(fp);
+        uint64_t id;
+
+        if (tag == EOF) {
+            ok = !ferror(fp);
+            break;
+        }
+        /* Writers number interfaces by slot, far below the bound */
+        if (!read_varint(fp, &id) || id > RECORD_MAX_ID || !state_reserve(&state, (size_t)id)) {
+            break;
+        }
+        record_iface_t *iface = &state.ifaces[id];
+
+        if (tag == RECORD_IFACE) {
+            if (names_capacity < state.capacity) {
+                char (*grown)[MAX_IFACE_LEN] = realloc(names, state.capacity * sizeof(*names));
+                if (!grown) {
+                    break;
+                }
+                names = grown;
+                names_capacity = state.capacity;
+            }
+            int len = getc_unlocked(fp);
+            if (len == EOF || len >= MAX_IFACE_LEN ||
+                fread(names[id], 1, (size_t)len, fp) != (size_t)len) {
+                break;
+            }
+            names[id][len] = '\0';
+            iface->defined = true;
+        } else if (tag == RECORD_GONE) {
+            iface->valid = false;
+        } else if (tag == RECORD_SAMPLE && iface->defined) {
+            uint64_t delta, counters[RECORD_COUNTERS];
+            net_stats_t current = {0}, previous = {0};
+
+            if (!read_varint(fp, &delta)) {
+                break;
+            }
+            uint64_t now = state.last_ns + unzigzag(delta);
+            size_t i;
+            for (i = 0; i < RECORD_COUNTERS && read_varint(fp, &delta); i++) {
+                counters[i] = iface->counters[i] + unzigzag(delta);
+            }
+            if (i < RECORD_COUNTERS) {
+                break;
+            }
+
+            memcpy(current.interface, names[id], MAX_IFACE_LEN);
+            counters_stats(counters, &current);
+            current.timestamp.tv_sec = (time_t)(now / NSEC_PER_SEC);
+            current.timestamp.tv_nsec = (long)(now % NSEC_PER_SEC);
+            current.valid = true;
+            counters_stats(iface->counters, &previous);
+            previous.timestamp.tv_sec = (time_t)(iface->time_ns / NSEC_PER_SEC);
+            previous.timestamp.tv_nsec = (long)(iface->time_ns % NSEC_PER_SEC);
+            previous.valid = iface->valid;
+
+            double elapsed = timespec_diff(&previous.timestamp, &current.timestamp);
+            if (format == OUTPUT_JSON) {
+                output_json_row(&out, &current.timestamp, &current, &previous, elapsed);
+            } else {
+                output_stats_row(&out, timestamp_format(&clock, &current.timestamp),
+                                 &current, &previous, elapsed);
+            }
+
+            memcpy(iface->counters, counters, sizeof(counters));
+            iface->time_ns = now;
+            iface->valid = true;
+            state.last_ns = now;
+        } else {
+            break;
+        }
+    }
+
+    if (!ok) {
+        fprintf(stderr, "Error: %s is truncated or corrupt\n", path);
+    }
+    if (!output_flush(&out)) {
+        ok = false;
+    }
+
+out:
+    output_free(&out);
+    record_state_free(&state);
+    free(names);
+    fclose(fp);
+    return ok;
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "netstat_monitor.h"
+#include "output.h"
+
+/*
+ * Binary capture format, all integers little-endian:
+ *
+ *   header  "NSMB", u16 version, u16 header size, u64 interval (ns),
+ *           u64 start time (ns since the epoch), u64 reserved
+ *   records one tag byte followed by LEB128 varints:
+ *     RECORD_IFACE   id, name length (one byte), name; repeated with the
+ *                    new name when an interface is renamed
+ *     RECORD_SAMPLE  id, zigzag time delta (ns) against the previous
+ *                    sample of any interface, then the eight counters as
+ *                    zigzag deltas against this interface's previous sample
+ *     RECORD_GONE    id; the interface vanished and its next sample
+ *                    starts a new baseline
+ */
+#define RECORD_MAGIC "NSMB"
+#define RECORD_VERSION 1
+#define RECORD_HEADER_SIZE 32
+#define RECORD_COUNTERS 8
+/*
+ * Largest interface id written or decoded. Decoder state grows to the
+ * largest id seen, so a corrupt id must not ask for gigabytes
+ */
+#define RECORD_MAX_ID ((UINT32_C(1) << 20) - 1)
+
+enum {
+    RECORD_IFACE = 1,
+    RECORD_SAMPLE = 2,
+    RECORD_GONE = 3,
+};
+
+typedef struct {
+    uint64_t counters[RECORD_COUNTERS];
+    uint64_t time_ns;
+    bool defined;
+    bool valid;
+} record_iface_t;
+
+/* Previous values per interface id, shared by the encoder and decoder */
+typedef struct {
+    record_iface_t *ifaces;
+    size_t capacity;
+    uint64_t last_ns;
+} record_state_t;
+
+void record_write_header(record_state_t *state, output_t *out, uint64_t interval_ns,
+                         const struct timespec *start);
+bool record_write_sample(record_state_t *state, output_t *out, size_t id,
+                         const struct timespec *wall, const net_stats_t *stats);
+void record_write_gone(record_state_t *state, output_t *out, size_t id);
+void record_rename(record_state_t *state, size_t id);
+void record_state_free(record_state_t *state);
+
+bool record_decode(const char *path, output_format_t format);
+
+#endif /* RECORD_H */
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "replay.h"
+
+/**
+ * Load a capture of concatenated /proc/net/dev snapshots, for example
+ * from `while :; do cat /proc/net/dev; sleep 1; done > capture`
+ * The whole file is read up front so replayed samples cost no I/O
+ */
+bool replay_open(replay_reader_t *reader, const char *path, const procfs_scanner_t *scanner) {
+    memset(reader, 0, sizeof(*reader));
+    reader->scanner = scanner;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+        fprintf(stderr, "Error: %s is not a regular file\n", path);
+        close(fd);
+        return false;
+    }
+
+    reader->data = malloc((size_t)st.st_size + 1);
+    if (!reader->data) {
+        fprintf(stderr, "Error: Cannot allocate %lld bytes for %s\n", (long long)st.st_size, path);
+        close(fd);
+        return false;
+    }
+
+    while (reader->size < (size_t)st.st_size) {
+        ssize_t n = read(fd, reader->data + reader->size, (size_t)st.st_size - reader->size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        reader->size += (size_t)n;
+    }
+    close(fd);
+    reader->data[reader->size] = '\0';
+
+    if (strncmp(reader->data, REPLAY_SNAPSHOT_MARK, strlen(REPLAY_SNAPSHOT_MARK)) != 0) {
+        fprintf(stderr, "Error: %s does not start with a /proc/net/dev snapshot\n", path);
+        replay_close(reader);
+        return false;
+    }
+    return true;
+}
+
+void replay_close(replay_reader_t *reader) {
+    free(reader->data);
+    reader->data = NULL;
+    reader->size = 0;
+    reader->offset = 0;
+}
+
+/**
+ * Fill the table from the next snapshot in the capture
+ * Samples are stamped with the current time, so rates are only faithful
+ * when replaying at the interval the capture was taken with
+ * Returns false and sets exhausted once every snapshot has been replayed
+ */
+bool replay_read_stats(replay_reader_t *reader, iface_table_t *table, bool *exhausted) {
+    if (reader->offset >= reader->size) {
+        *exhausted = true;
+        return false;
+    }
+
+    char *start = reader->data + reader->offset;
+    char *next = strstr(start + 1, "\n" REPLAY_SNAPSHOT_MARK);
+    char *end = next ? next + 1 : reader->data + reader->size;
+
+    /* Terminate the snapshot in place for the parser, then restore it */
+    char saved = *end;
+    *end = '\0';
+    procfs_parse_buffer(reader->scanner, start, table);
+    *end = saved;
+
+    reader->io.bytes += (uint64_t)(end - start);
+    reader->offset = (size_t)(end - reader->data);
+
+    iface_table_stamp(table);
+    return true;
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stddef.h>
+
+#include "netstat_monitor.h"
+#include "iface_table.h"
+#include "procfs.h"
+
+/* Every /proc/net/dev snapshot starts with this header line */
+#define REPLAY_SNAPSHOT_MARK "Inter-|"
+
+typedef struct {
+    char *data;
+    size_t size;
+    size_t offset;
+    const procfs_scanner_t *scanner;
+    io_counters_t io;
+} replay_reader_t;
+
+bool replay_open(replay_reader_t *reader, const char *path, const procfs_scanner_t *scanner);
+void replay_close(replay_reader_t *reader);
+bool replay_read_stats(replay_reader_t *reader, iface_table_t *table, bool *exhausted);
+
+#endif /* REPLAY_H */
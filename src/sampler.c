@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "sampler.h"
+
+static void notify(int fd) {
+    uint64_t one = 1;
+    ssize_t n = write(fd, &one, sizeof(one));
+    (void)n;
+}
+
+static bool sample_reserve(sample_t *sample, size_t count, size_t names, size_t changes) {
+    if (count > sample->capacity) {
+        size_t capacity = sample->capacity ? sample->capacity : 64;
+        while (capacity < count) {
+            capacity *= 2;
+        }
+        for (int c = 0; c < IFACE_COUNTERS; c++) {
+            uint64_t *column = realloc(sample->counters[c], capacity * sizeof(*column));
+            if (!column) {
+                return false;
+            }
+            sample->counters[c] = column;
+        }
+        int64_t *time_ns = realloc(sample->time_ns, capacity * sizeof(*time_ns));
+        if (!time_ns) {
+            return false;
+        }
+        sample->time_ns = time_ns;
+        uint8_t *seen = realloc(sample->seen, capacity * sizeof(*seen));
+        if (!seen) {
+            return false;
+        }
+        sample->seen = seen;
+        sample->capacity = capacity;
+    }
+    if (names > sample->names_capacity) {
+        char (*grown)[MAX_IFACE_LEN] = realloc(sample->names, names * sizeof(*grown));
+        if (!grown) {
+            return false;
+        }
+        sample->names = grown;
+        sample->names_capacity = names;
+    }
+    if (changes > sample->change_capacity) {
+        sample_change_t *grown = realloc(sample->changes, changes * sizeof(*grown));
+        if (!grown) {
+            return false;
+        }
+        sample->changes = grown;
+        sample->change_capacity = changes;
+    }
+    return true;
+}
+
+/**
+ * Transpose the table into the next free ring entry and publish it
+ * Returns false if the ring was full and the sample was dropped
+ */
+static bool push(sampler_t *sampler, bool end) {
+    size_t tail = atomic_load_explicit(&sampler->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&sampler->head, memory_order_acquire);
+
+    if (tail - head == sampler->depth) {
+        if (!end) {
+            atomic_fetch_add_explicit(&sampler->dropped, 1, memory_order_relaxed);
+        }
+        return false;
+    }
+
+    sample_t *sample = &sampler->ring[tail % sampler->depth];
+    iface_table_t *table = sampler->table;
+    size_t count = end ? 0 : table->count;
+    size_t first_new = sampler->named < count ? sampler->named : count;
+    size_t changes = end ? 0 : table->changed;
+
+    if (!sample_reserve(sample, count, count - first_new, changes)) {
+        atomic_fetch_add_explicit(&sampler->dropped, 1, memory_order_relaxed);
+        return false;
+    }
+    sample->end = end;
+    sample->grid = sampler->sched->ticks + sampler->sched->missed;
+    clock_gettime(CLOCK_REALTIME, &sample->wall);
+    sample->count = count;
+    sample->first_new = first_new;
+    for (size_t i = 0; i < count; i++) {
+        const net_stats_t *stats = &table->slots[i].current;
+        sample->counters[IFACE_RX_BYTES][i] = stats->rx_bytes;
+        sample->counters[IFACE_RX_PACKETS][i] = stats->rx_packets;
+        sample->counters[IFACE_RX_ERRORS][i] = stats->rx_errors;
+        sample->counters[IFACE_RX_DROPS][i] = stats->rx_drops;
+        sample->counters[IFACE_TX_BYTES][i] = stats->tx_bytes;
+        sample->counters[IFACE_TX_PACKETS][i] = stats->tx_packets;
+        sample->counters[IFACE_TX_ERRORS][i] = stats->tx_errors;
+        sample->counters[IFACE_TX_DROPS][i] = stats->tx_drops;
+        sample->time_ns[i] = (int64_t)stats->timestamp.tv_sec * (int64_t)NSEC_PER_SEC +
+                             stats->timestamp.tv_nsec;
+        sample->seen[i] = table->slots[i].seen;
+    }
+    for (size_t i = first_new; i < count; i++) {
+        memcpy(sample->names[i - first_new], table->slots[i].current.interface, MAX_IFACE_LEN);
+    }
+    sample->change_count = 0;
+    for (size_t i = 0; i < count && sample->change_count < changes; i++) {
+        const iface_slot_t *slot = &table->slots[i];
+        if (slot->changes) {
+            sample_change_t *change = &sample->changes[sample->change_count++];
+            change->id = i;
+            change->changes = slot->changes;
+            memcpy(change->name, slot->current.interface, MAX_IFACE_LEN);
+        }
+    }
+
+    atomic_store_explicit(&sampler->tail, tail + 1, memory_order_release);
+    /* Names only count as sent once the sample carrying them is queued */
+    if (count > sampler->named) {
+        sampler->named = count;
+    }
+    if (changes) {
+        iface_table_clear_changes(table);
+    }
+    notify(sampler->wake.fd);
+    return true;
+}
+
+/**
+ * Copy a sample into the output thread's table, adding the slots it
+ * introduces and applying its changes. The sampler's table only appends,
+ * so ids line up
+ */
+bool sample_apply(const sample_t *sample, iface_soa_t *soa) {
+    for (size_t i = soa->count; i < sample->count; i++) {
+        const char *name = sample->names[i - sample->first_new];
+        if (i < sample->first_new || !iface_soa_add(soa, name, strlen(name))) {
+            return false;
+        }
+    }
+    size_t n = sample->count;
+    for (int c = 0; c < IFACE_COUNTERS; c++) {
+        memcpy(soa->current[c], sample->counters[c], n * sizeof(uint64_t));
+    }
+    memcpy(soa->time_ns, sample->time_ns, n * sizeof(int64_t));
+    memcpy(soa->seen, sample->seen, n);
+
+    for (size_t k = 0; k < sample->change_count; k++) {
+        const sample_change_t *change = &sample->changes[k];
+        if (change->changes & (IFACE_CHANGE_RESTARTED | IFACE_CHANGE_REMOVED)) {
+            iface_soa_restart(soa, change->id);
+        }
+        if ((change->changes & IFACE_CHANGE_RENAMED) &&
+            !iface_soa_rename(soa, change->id, change->name, strlen(change->name))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void *sampler_main(void *arg) {
+    sampler_t *sampler = arg;
+    /* poll() skips the events entry while its fd is -1 */
+    struct pollfd fds[3] = {
+        {.fd = sampler->sched->timer_fd, .events = POLLIN},
+        {.fd = sampler->stop_fd, .events = POLLIN},
+        {.fd = sampler->events ? sampler->events->fd : -1, .events = POLLIN},
+    };
+
+    for (;;) {
+        if (poll(fds, 3, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "Error: Sampler poll failed: %s\n", strerror(errno));
+            break;
+        }
+        if (fds[1].revents) {
+            return NULL;
+        }
+        if (fds[2].revents) {
+            netlink_events_process(sampler->events, sampler->table);
+        }
+        if (!scheduler_expire(sampler->sched)) {
+            continue;
+        }
+        /* Catch events queued since poll() returned, so that a link just
+         * deleted is reported as removed rather than as missing */
+        if (sampler->events) {
+            netlink_events_process(sampler->events, sampler->table);
+        }
+        if (collector_sample(sampler->collector, sampler->table)) {
+            push(sampler, false);
+        } else if (sampler->collector->exhausted) {
+            break;
+        }
+    }
+
+    /* Tell the output thread there is nothing more to come */
+    while (!push(sampler, true)) {
+        struct pollfd stop = {.fd = sampler->stop_fd, .events = POLLIN};
+        if (poll(&stop, 1, 10) > 0) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+/* Wake-ups only need draining; the ring itself says what arrived */
+static void on_wake(event_source_t *source, uint32_t events) {
+    uint64_t count;
+    ssize_t n = read(source->fd, &count, sizeof(count));
+    (void)n;
+    (void)events;
+}
+
+/**
+ * Ring depth for samples of up to capacity interfaces, so that the
+ * columns in flight stay within SAMPLER_QUEUE_BUDGET
+ */
+size_t sampler_queue_depth(size_t capacity) {
+    size_t per_sample = (capacity ? capacity : 1) *
+                        (IFACE_COUNTERS * sizeof(uint64_t) + sizeof(int64_t) + sizeof(uint8_t));
+    size_t depth = SAMPLER_QUEUE_BUDGET / per_sample;
+    if (depth < SAMPLER_QUEUE_MIN) {
+        return SAMPLER_QUEUE_MIN;
+    }
+    return depth < SAMPLER_QUEUE_SIZE ? depth : SAMPLER_QUEUE_SIZE;
+}
+
+/**
+ * Hand the collector, table, scheduler and link events, if any, over to a
+ * new sampler thread, with a ring sized for capacity interfaces. The
+ * caller must not touch them again until sampler_stop()
+ */
+bool sampler_start(sampler_t *sampler, collector_t *collector, iface_table_t *table,
+                   scheduler_t *sched, netlink_events_t *events, event_loop_t *loop,
+                   size_t capacity) {
+    memset(sampler, 0, sizeof(*sampler));
+    sampler->depth = sampler_queue_depth(capacity);
+    sampler->collector = collector;
+    sampler->table = table;
+    sampler->sched = sched;
+    sampler->events = events;
+    sampler->loop = loop;
+    sampler->wake.callback = on_wake;
+    sampler->wake.ctx = sampler;
+    sampler->wake.fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    sampler->stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (sampler->wake.fd < 0 || sampler->stop_fd < 0) {
+        fprintf(stderr, "Error: Cannot create eventfd: %s\n", strerror(errno));
+        sampler_stop(sampler);
+        return false;
+    }
+    if (!event_loop_add(loop, &sampler->wake, EPOLLIN)) {
+        sampler_stop(sampler);
+        return false;
+    }
+
+    int rc = pthread_create(&sampler->thread, NULL, sampler_main, sampler);
+    if (rc != 0) {
+        fprintf(stderr, "Error: Cannot start sampler thread: %s\n", strerror(rc));
+        sampler_stop(sampler);
+        return false;
+    }
+    sampler->running = true;
+    return true;
+}
+
+/* The oldest unconsumed sample, or NULL if the ring is empty */
+const sample_t *sampler_peek(sampler_t *sampler) {
+    size_t head = atomic_load_explicit(&sampler->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&sampler->tail, memory_order_acquire);
+    if (head == tail) {
+        return NULL;
+    }
+    return &sampler->ring[head % sampler->depth];
+}
+
+/* Give the sample returned by sampler_peek() back to the sampler */
+void sampler_release(sampler_t *sampler) {
+    size_t head = atomic_load_explicit(&sampler->head, memory_order_relaxed);
+    atomic_store_explicit(&sampler->head, head + 1, memory_order_release);
+}
+
+/**
+ * Stop and join the sampler thread; afterwards the collector, table,
+ * scheduler and link events belong to the caller again
+ */
+void sampler_stop(sampler_t *sampler) {
+    if (sampler->running) {
+        notify(sampler->stop_fd);
+        pthread_join(sampler->thread, NULL);
+        sampler->running = false;
+    }
+    if (sampler->wake.fd >= 0) {
+        event_loop_remove(sampler->loop, &sampler->wake);
+        close(sampler->wake.fd);
+    }
+    if (sampler->stop_fd >= 0) {
+        close(sampler->stop_fd);
+    }
+    sampler->wake.fd = -1;
+    sampler->stop_fd = -1;
+    for (size_t i = 0; i < SAMPLER_QUEUE_SIZE; i++) {
+        sample_t *sample = &sampler->ring[i];
+        for (int c = 0; c < IFACE_COUNTERS; c++) {
+            free(sample->counters[c]);
+        }
+        free(sample->time_ns);
+        free(sample->seen);
+        free(sample->names);
+        free(sample->changes);
+        memset(sample, 0, sizeof(*sample));
+    }
+}
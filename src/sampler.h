@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "netstat_monitor.h"
+#include "iface_table.h"
+#include "iface_soa.h"
+#include "collector.h"
+#include "netlink.h"
+#include "scheduler.h"
+#include "event_loop.h"
+
+/*
+ * Snapshots in flight between the sampler and output threads: as many as
+ * fit in SAMPLER_QUEUE_BUDGET bytes of columns, between SAMPLER_QUEUE_MIN
+ * and SAMPLER_QUEUE_SIZE
+ */
+#define SAMPLER_QUEUE_SIZE 256
+#define SAMPLER_QUEUE_MIN 4
+#define SAMPLER_QUEUE_BUDGET (4u << 20)
+
+/* A slot's IFACE_CHANGE_* flags and the name it has after them */
+typedef struct {
+    size_t id;
+    uint8_t changes;
+    char name[MAX_IFACE_LEN];
+} sample_change_t;
+
+/*
+ * One sample of every slot in columns, ready to be copied into an
+ * iface_soa_t. Names travel only with the sample that first carries a
+ * slot: names[k] belongs to slot first_new + k. Later renames, removals
+ * and reused ids come as changes. grid is the position on the scheduler
+ * grid, missed deadlines included
+ */
+typedef struct {
+    struct timespec wall;
+    uint64_t grid;
+    size_t count;
+    size_t capacity;
+    uint64_t *counters[IFACE_COUNTERS];
+    int64_t *time_ns;
+    uint8_t *seen;
+    size_t first_new;
+    char (*names)[MAX_IFACE_LEN];
+    size_t names_capacity;
+    sample_change_t *changes;
+    size_t change_count;
+    size_t change_capacity;
+    bool end;
+} sample_t;
+
+/*
+ * The sampler thread owns the collector, its table, the scheduler and
+ * the link event socket, whose events it applies to the table as they
+ * arrive. It pushes a snapshot per tick into a single-producer single-consumer ring
+ * and pokes an eventfd that the output thread's loop watches. When the
+ * ring is full the snapshot is dropped and counted, never waited for
+ */
+typedef struct {
+    sample_t ring[SAMPLER_QUEUE_SIZE];
+    size_t depth;
+    _Alignas(64) _Atomic size_t head;
+    _Alignas(64) _Atomic size_t tail;
+    _Alignas(64) _Atomic uint64_t dropped;
+    collector_t *collector;
+    iface_table_t *table;
+    scheduler_t *sched;
+    netlink_events_t *events;
+    size_t named;
+    event_loop_t *loop;
+    event_source_t wake;
+    int stop_fd;
+    pthread_t thread;
+    bool running;
+} sampler_t;
+
+size_t sampler_queue_depth(size_t capacity);
+bool sampler_start(sampler_t *sampler, collector_t *collector, iface_table_t *table,
+                   scheduler_t *sched, netlink_events_t *events, event_loop_t *loop,
+                   size_t capacity);
+const sample_t *sampler_peek(sampler_t *sampler);
+void sampler_release(sampler_t *sampler);
+bool sample_apply(const sample_t *sample, iface_soa_t *soa);
+void sampler_stop(sampler_t *sampler);
+
+#endif /* SAMPLER_H */
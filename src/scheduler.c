@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+#include "scheduler.h"
+#include "netstat_monitor.h"
+
+static uint64_t timespec_to_ns(const struct timespec *ts) {
+    return (uint64_t)ts->tv_sec * NSEC_PER_SEC + (uint64_t)ts->tv_nsec;
+}
+
+static struct timespec ns_to_timespec(uint64_t ns) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)(ns / NSEC_PER_SEC);
+    ts.tv_nsec = (long)(ns % NSEC_PER_SEC);
+    return ts;
+}
+
+static uint64_t monotonic_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return timespec_to_ns(&now);
+}
+
+/**
+ * Parse an interval such as "2", "0.01", "10ms", "250us", "1.5s" or "1h"
+ * A bare number is in seconds; the fraction is read digit by digit so
+ * that "0.01" is exactly 10 ms rather than the nearest double
+ */
+bool scheduler_parse_interval(const char *arg, uint64_t *interval_ns) {
+    static const struct {
+        const char *suffix;
+        uint64_t scale;
+    } units[] = {
+        {"", NSEC_PER_SEC}, {"s", NSEC_PER_SEC}, {"ms", UINT64_C(1000000)},
+        {"us", UINT64_C(1000)}, {"ns", 1}, {"min", 60 * NSEC_PER_SEC},
+        {"h", 3600 * NSEC_PER_SEC},
+    };
+    const char *p = arg;
+    uint64_t whole = 0;
+    uint64_t frac = 0;
+    uint64_t frac_scale = 1;
+    bool digits = false;
+
+    for (; *p >= '0' && *p <= '9'; p++) {
+        if (whole > UINT64_MAX / 10 / NSEC_PER_SEC) {
+            return false;
+        }
+        whole = whole * 10 + (uint64_t)(*p - '0');
+        digits = true;
+    }
+    if (*p == '.') {
+        for (p++; *p >= '0' && *p <= '9'; p++) {
+            /* Digits past nanosecond resolution cannot change the result */
+            if (frac_scale < NSEC_PER_SEC) {
+                frac = frac * 10 + (uint64_t)(*p - '0');
+                frac_scale *= 10;
+            }
+            digits = true;
+        }
+    }
+    if (!digits) {
+        return false;
+    }
+
+    for (size_t i = 0; i < sizeof(units) / sizeof(units[0]); i++) {
+        if (strcmp(p, units[i].suffix) != 0) {
+            continue;
+        }
+        uint64_t scale = units[i].scale;
+        if (whole > (UINT64_MAX - scale) / scale) {
+            return false;
+        }
+        /* Scales of a second and up are multiples of frac_scale <= 1e9 */
+        if (scale >= NSEC_PER_SEC) {
+            *interval_ns = whole * scale + frac * (scale / frac_scale);
+        } else {
+            *interval_ns = whole * scale + frac * scale / frac_scale;
+        }
+        return *interval_ns >= SCHEDULER_MIN_INTERVAL_NS;
+    }
+    return false;
+}
+
+/**
+ * Format an interval in seconds without trailing zeros ("2", "0.01")
+ */
+void scheduler_format_interval(uint64_t interval_ns, char *buffer, size_t bufsize) {
+    uint64_t frac = interval_ns % NSEC_PER_SEC;
+    int width = 9;
+
+    if (frac == 0) {
+        snprintf(buffer, bufsize, "%llu", (unsigned long long)(interval_ns / NSEC_PER_SEC));
+        return;
+    }
+    while (frac % 10 == 0) {
+        frac /= 10;
+        width--;
+    }
+    snprintf(buffer, bufsize, "%llu.%0*llu", (unsigned long long)(interval_ns / NSEC_PER_SEC),
+             width, (unsigned long long)frac);
+}
+
+/**
+ * Anchor the sampling grid at the current time and arm a periodic
+ * timerfd on it; the first deadline is one interval from now
+ */
+bool scheduler_init(scheduler_t *sched, uint64_t interval_ns) {
+    memset(sched, 0, sizeof(*sched));
+    sched->interval_ns = interval_ns;
+    sched->next = ns_to_timespec(monotonic_ns() + interval_ns);
+    sched->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (sched->timer_fd < 0) {
+        fprintf(stderr, "Error: Cannot create timerfd: %s\n", strerror(errno));
+        return false;
+    }
+
+    struct itimerspec spec = {
+        .it_interval = ns_to_timespec(interval_ns),
+        .it_value = sched->next,
+    };
+    if (timerfd_settime(sched->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) != 0) {
+        fprintf(stderr, "Error: Cannot arm timerfd: %s\n", strerror(errno));
+        scheduler_close(sched);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Account for a readable timer_fd; one read returns how many deadlines
+ * have passed since the last one. If whole periods have gone by, they
+ * are counted as missed and skipped rather than sampled back to back;
+ * the sample is taken at once and the grid phase is kept
+ * Returns false if no deadline had passed after all
+ */
+bool scheduler_expire(scheduler_t *sched) {
+    uint64_t expirations;
+
+    if (read(sched->timer_fd, &expirations, sizeof(expirations)) != (ssize_t)sizeof(expirations) ||
+        expirations == 0) {
+        return false;
+    }
+    uint64_t deadline = timespec_to_ns(&sched->next) + (expirations - 1) * sched->interval_ns;
+    uint64_t now = monotonic_ns();
+
+    sched->missed += expirations - 1;
+    latency_record(&sched->lateness, now > deadline ? now - deadline : 0);
+    sched->ticks++;
+    sched->next = ns_to_timespec(deadline + sched->interval_ns);
+    return true;
+}
+
+void scheduler_close(scheduler_t *sched) {
+    if (sched->timer_fd >= 0) {
+        close(sched->timer_fd);
+        sched->timer_fd = -1;
+    }
+}
+
+void scheduler_print_summary(const scheduler_t *sched, FILE *out) {
+    const latency_stats_t *lateness = &sched->lateness;
+    if (lateness->samples == 0) {
+        return;
+    }
+
+    fprintf(out, "Scheduling: %llu ticks, %llu missed deadlines\n",
+            (unsigned long long)sched->ticks, (unsigned long long)sched->missed);
+    fprintf(out, "  jitter: min %.1f us, avg %.1f us, p99 %.1f us, max %.1f us\n",
+            (double)lateness->min_ns / 1e3,
+            (double)lateness->total_ns / (double)lateness->samples / 1e3,
+            (double)latency_percentile(lateness, 99.0) / 1e3,
+            (double)lateness->max_ns / 1e3);
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "latency.h"
+
+/*
+ * Samples are taken on the fixed grid start + k * interval of
+ * CLOCK_MONOTONIC, so the time spent collecting and printing never
+ * pushes later samples back. A periodic timerfd fires on the grid;
+ * the caller waits for timer_fd to become readable, then calls
+ * scheduler_expire()
+ */
+typedef struct {
+    struct timespec next;
+    uint64_t interval_ns;
+    uint64_t ticks;
+    uint64_t missed;
+    latency_stats_t lateness;
+    int timer_fd;
+} scheduler_t;
+
+/* Shortest accepted sampling interval */
+#define SCHEDULER_MIN_INTERVAL_NS UINT64_C(1000000)
+
+bool scheduler_parse_interval(const char *arg, uint64_t *interval_ns);
+void scheduler_format_interval(uint64_t interval_ns, char *buffer, size_t bufsize);
+bool scheduler_init(scheduler_t *sched, uint64_t interval_ns);
+bool scheduler_expire(scheduler_t *sched);
+void scheduler_close(scheduler_t *sched);
+void scheduler_print_summary(const scheduler_t *sched, FILE *out);
+
+#endif /* SCHEDULER_H */
@@ -0,0 +1,307 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "shm_stats.h"
+
+static inline size_t header_size(void) {
+    return (sizeof(shm_stats_header_t) + 63) / 64 * 64;
+}
+
+static inline shm_stats_entry_t *header_entries(const shm_stats_header_t *header) {
+    return (shm_stats_entry_t *)((char *)header + header->header_size);
+}
+
+/* POSIX shared memory names start with a single slash */
+static bool normalize_name(const char *name, char *buffer, size_t bufsize) {
+    int len = snprintf(buffer, bufsize, "%s%s", name[0] == '/' ? "" : "/", name);
+    return len > 1 && (size_t)len < bufsize && strchr(buffer + 1, '/') == NULL;
+}
+
+/* Attempts before a seq that stays odd or moving is reported as busy */
+#define SHM_STATS_READ_RETRIES 1000
+
+/**
+ * True if pid may still be publishing: it exists, even if owned by
+ * another user
+ */
+bool shm_stats_writer_alive(int64_t pid) {
+    return pid > 0 && (kill((pid_t)pid, 0) == 0 || errno == EPERM);
+}
+
+/**
+ * Read the pid stored in an existing segment; false if it is not a
+ * complete netstat_monitor segment
+ */
+static bool segment_pid(const char *path, int64_t *pid) {
+    struct stat st;
+    int fd = shm_open(path, O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < header_size()) {
+        close(fd);
+        return false;
+    }
+    const shm_stats_header_t *header = mmap(NULL, header_size(), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (header == MAP_FAILED) {
+        return false;
+    }
+    bool ok = memcmp(header->magic, SHM_STATS_MAGIC, 4) == 0;
+    *pid = header->pid;
+    munmap((void *)header, header_size());
+    return ok;
+}
+
+/**
+ * Create the segment with room for capacity interfaces. A segment left
+ * by a monitor that has exited is replaced; readers still mapping it
+ * keep their old copy. One owned by a running monitor is left alone
+ */
+bool shm_stats_create(shm_stats_t *shm, const char *name, uint64_t interval_ns, size_t capacity) {
+    memset(shm, 0, sizeof(*shm));
+    if (!normalize_name(name, shm->name, sizeof(shm->name))) {
+        fprintf(stderr, "Error: Invalid shared memory name: %s\n", name);
+        return false;
+    }
+
+    size_t map_size = header_size() + capacity * sizeof(shm_stats_entry_t);
+    int fd = shm_open(shm->name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0 && errno == EEXIST) {
+        int64_t pid = 0;
+        if (!segment_pid(shm->name, &pid)) {
+            fprintf(stderr, "Error: Shared memory %s exists and is not a netstat_monitor "
+                    "segment\n", shm->name);
+            return false;
+        }
+        if (shm_stats_writer_alive(pid)) {
+            fprintf(stderr, "Error: Shared memory %s is in use by netstat_monitor pid %lld\n",
+                    shm->name, (long long)pid);
+            return false;
+        }
+        shm_unlink(shm->name);
+        fd = shm_open(shm->name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    }
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot create shared memory %s: %s\n", shm->name, strerror(errno));
+        return false;
+    }
+    if (ftruncate(fd, (off_t)map_size) != 0) {
+        fprintf(stderr, "Error: Cannot size shared memory %s: %s\n", shm->name, strerror(errno));
+        close(fd);
+        shm_unlink(shm->name);
+        return false;
+    }
+    void *map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Error: Cannot map shared memory %s: %s\n", shm->name, strerror(errno));
+        shm_unlink(shm->name);
+        return false;
+    }
+    shm->map = map;
+    shm->map_size = map_size;
+
+    shm_stats_header_t *header = map;
+    header->version = SHM_STATS_VERSION;
+    header->header_size = (uint32_t)header_size();
+    header->entry_size = sizeof(shm_stats_entry_t);
+    header->capacity = (uint32_t)capacity;
+    header->interval_ns = interval_ns;
+    header->pid = (int64_t)getpid();
+    atomic_thread_fence(memory_order_release);
+    /* Readers check the magic last */
+    memcpy(header->magic, SHM_STATS_MAGIC, 4);
+    return true;
+}
+
+static void gather(net_stats_t *stats, const char *name, uint64_t *const columns[],
+                   size_t id, int64_t time_ns, bool valid) {
+    memcpy(stats->interface, name, strlen(name) + 1);
+    stats->rx_bytes = columns[IFACE_RX_BYTES][id];
+    stats->rx_packets = columns[IFACE_RX_PACKETS][id];
+    stats->rx_errors = columns[IFACE_RX_ERRORS][id];
+    stats->rx_drops = columns[IFACE_RX_DROPS][id];
+    stats->tx_bytes = columns[IFACE_TX_BYTES][id];
+    stats->tx_packets = columns[IFACE_TX_PACKETS][id];
+    stats->tx_errors = columns[IFACE_TX_ERRORS][id];
+    stats->tx_drops = columns[IFACE_TX_DROPS][id];
+    stats->timestamp.tv_sec = (time_t)(time_ns / (int64_t)NSEC_PER_SEC);
+    stats->timestamp.tv_nsec = (long)(time_ns % (int64_t)NSEC_PER_SEC);
+    stats->valid = valid;
+}
+
+/**
+ * Publish the table with the rates iface_soa_compute() left in its
+ * columns, against the previous sample it still holds. Columns are read
+ * directly so the reader library needs no iface_soa.c
+ */
+void shm_stats_publish(shm_stats_t *shm, const iface_soa_t *table, const struct timespec *wall) {
+    shm_stats_header_t *header = shm->map;
+    shm_stats_entry_t *entries = header_entries(header);
+    size_t count = table->count;
+
+    if (count > header->capacity) {
+        if (!shm->overflow_warned) {
+            fprintf(stderr, "Warning: Shared memory holds %u interfaces; later ones are not "
+                    "published\n", header->capacity);
+            shm->overflow_warned = true;
+        }
+        count = header->capacity;
+    }
+
+    uint64_t seq = atomic_load_explicit(&header->seq, memory_order_relaxed);
+    atomic_store_explicit(&header->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    header->count = (uint32_t)count;
+    header->tick++;
+    header->time_ns = (uint64_t)wall->tv_sec * NSEC_PER_SEC + (uint64_t)wall->tv_nsec;
+
+    for (size_t i = 0; i < count; i++) {
+        shm_stats_entry_t *entry = &entries[i];
+        const char *name = iface_soa_name(table, i);
+        bool seen = table->seen[i];
+
+        gather(&entry->current, name, table->current, i, table->time_ns[i], seen);
+        gather(&entry->previous, name, table->previous, i, table->previous_ns[i],
+               seen && table->has_previous[i]);
+        entry->elapsed = table->elapsed[i];
+        entry->rx_bytes_rate = table->rate[IFACE_RX_BYTES][i];
+        entry->rx_packets_rate = table->rate[IFACE_RX_PACKETS][i];
+        entry->tx_bytes_rate = table->rate[IFACE_TX_BYTES][i];
+        entry->tx_packets_rate = table->rate[IFACE_TX_PACKETS][i];
+    }
+
+    atomic_store_explicit(&header->seq, seq + 2, memory_order_release);
+}
+
+void shm_stats_destroy(shm_stats_t *shm) {
+    if (shm->map) {
+        munmap(shm->map, shm->map_size);
+        shm_unlink(shm->name);
+        shm->map = NULL;
+    }
+}
+
+/**
+ * Map a segment published by netstat_monitor --shm. Reading it afterwards
+ * takes no system calls
+ */
+bool shm_stats_open(shm_stats_reader_t *reader, const char *name) {
+    char path[256];
+    struct stat st;
+
+    memset(reader, 0, sizeof(*reader));
+    if (!normalize_name(name, path, sizeof(path))) {
+        fprintf(stderr, "Error: Invalid shared memory name: %s\n", name);
+        return false;
+    }
+    int fd = shm_open(path, O_RDONLY, 0);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open shared memory %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < header_size()) {
+        fprintf(stderr, "Error: %s is not a netstat_monitor segment\n", path);
+        close(fd);
+        return false;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Error: Cannot map shared memory %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    const shm_stats_header_t *header = map;
+    if (memcmp(header->magic, SHM_STATS_MAGIC, 4) != 0 || header->version != SHM_STATS_VERSION ||
+        header->entry_size != sizeof(shm_stats_entry_t) || header->header_size != header_size() ||
+        (size_t)st.st_size < header->header_size + (size_t)header->capacity * header->entry_size) {
+        fprintf(stderr, "Error: %s is not a netstat_monitor segment of this version\n", path);
+        munmap(map, (size_t)st.st_size);
+        return false;
+    }
+
+    reader->header = header;
+    reader->map_size = (size_t)st.st_size;
+    return true;
+}
+
+size_t shm_stats_capacity(const shm_stats_reader_t *reader) {
+    return reader->header->capacity;
+}
+
+/**
+ * Copy a consistent snapshot of up to max entries, retrying while the
+ * monitor is mid-publish. A seq that stays odd or moving for
+ * SHM_STATS_READ_RETRIES attempts gives SHM_STATS_BUSY, with info->pid
+ * set so the caller can tell a dead writer from a busy one
+ */
+shm_stats_status_t shm_stats_read(const shm_stats_reader_t *reader, shm_stats_entry_t *entries,
+                                  size_t max, shm_stats_info_t *info) {
+    /* The reader only loads; the writer owns seq */
+    shm_stats_header_t *header = (shm_stats_header_t *)reader->header;
+    const shm_stats_entry_t *source = header_entries(header);
+
+    memset(info, 0, sizeof(*info));
+    info->pid = header->pid;
+    for (int i = 0; i < SHM_STATS_READ_RETRIES; i++) {
+        if (i) {
+            sched_yield();
+        }
+        uint64_t before = atomic_load_explicit(&header->seq, memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        size_t count = header->count;
+        if (count > header->capacity) {
+            continue;
+        }
+        info->interval_ns = header->interval_ns;
+        info->tick = header->tick;
+        info->time_ns = header->time_ns;
+        info->pid = header->pid;
+        info->count = count < max ? count : max;
+        memcpy(entries, source, info->count * sizeof(*entries));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&header->seq, memory_order_relaxed) == before) {
+            return info->tick != 0 ? SHM_STATS_OK : SHM_STATS_EMPTY;
+        }
+    }
+    return SHM_STATS_BUSY;
+}
+
+void shm_stats_close(shm_stats_reader_t *reader) {
+    if (reader->header) {
+        munmap((void *)reader->header, reader->map_size);
+        reader->header = NULL;
+    }
+}
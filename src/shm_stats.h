@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SHM_STATS_H
+#define SHM_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "netstat_monitor.h"
+#include "iface_soa.h"
+
+#define SHM_STATS_MAGIC "NSMS"
+#define SHM_STATS_VERSION 1
+#define SHM_STATS_DEFAULT_NAME "/netstat_monitor"
+
+/*
+ * Latest-stats segment: a header followed by capacity entries. The whole
+ * table is one seqlock: the monitor makes seq odd, rewrites the header
+ * fields and entries, then makes it even. Readers map the segment once
+ * and copy it without any system call, retrying if seq was odd or moved
+ * A seq that stays odd means the monitor died mid-publish; pid tells
+ * readers and a new monitor whether the writer is still alive
+ */
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t entry_size;
+    uint32_t capacity;
+    uint32_t count;
+    uint64_t interval_ns;
+    _Atomic uint64_t seq;
+    uint64_t tick;
+    uint64_t time_ns;
+    int64_t pid;
+} shm_stats_header_t;
+
+typedef struct {
+    net_stats_t current;
+    /* Valid once the interface has been sampled twice in a row */
+    net_stats_t previous;
+    double elapsed;
+    double rx_bytes_rate;
+    double rx_packets_rate;
+    double tx_bytes_rate;
+    double tx_packets_rate;
+} shm_stats_entry_t;
+
+/* What a reader gets with each snapshot */
+typedef struct {
+    uint64_t interval_ns;
+    uint64_t tick;
+    uint64_t time_ns;
+    int64_t pid;
+    size_t count;
+} shm_stats_info_t;
+
+typedef struct {
+    char name[256];
+    void *map;
+    size_t map_size;
+    bool overflow_warned;
+} shm_stats_t;
+
+typedef struct {
+    const shm_stats_header_t *header;
+    size_t map_size;
+} shm_stats_reader_t;
+
+/* Writer */
+bool shm_stats_create(shm_stats_t *shm, const char *name, uint64_t interval_ns, size_t capacity);
+void shm_stats_publish(shm_stats_t *shm, const iface_soa_t *table, const struct timespec *wall);
+void shm_stats_destroy(shm_stats_t *shm);
+
+typedef enum {
+    SHM_STATS_OK,
+    /* The monitor has not published anything yet */
+    SHM_STATS_EMPTY,
+    /* seq stayed odd or kept moving; see shm_stats_writer_alive() */
+    SHM_STATS_BUSY,
+} shm_stats_status_t;
+
+/* Reader */
+bool shm_stats_open(shm_stats_reader_t *reader, const char *name);
+size_t shm_stats_capacity(const shm_stats_reader_t *reader);
+shm_stats_status_t shm_stats_read(const shm_stats_reader_t *reader, shm_stats_entry_t *entries,
+                                  size_t max, shm_stats_info_t *info);
+bool shm_stats_writer_alive(int64_t pid);
+void shm_stats_close(shm_stats_reader_t *reader);
+
+#endif /* SHM_STATS_H */
@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+
+#include "sysfs.h"
+
+/* Order matters: see sysfs_store() */
+static const char *const sysfs_counter_names[SYSFS_COUNTERS] = {
+    "rx_bytes", "rx_packets", "rx_errors", "rx_dropped", "rx_missed_errors",
+    "tx_bytes", "tx_packets", "tx_errors", "tx_dropped",
+};
+
+static void sysfs_close_slot(int *fds, io_counters_t *io) {
+    for (int c = 0; c < SYSFS_COUNTERS; c++) {
+        if (fds[c] >= 0) {
+            close(fds[c]);
+            fds[c] = -1;
+            io->syscalls++;
+        }
+    }
+}
+
+/**
+ * Open the statistics files of one interface
+ * Returns false, with every descriptor closed, if any of them is missing
+ */
+static bool sysfs_open_slot(int *fds, const char *interface, io_counters_t *io) {
+    char path[256];
+    for (int c = 0; c < SYSFS_COUNTERS; c++) {
+        snprintf(path, sizeof(path), SYS_CLASS_NET "/%s/statistics/%s",
+                 interface, sysfs_counter_names[c]);
+        fds[c] = open(path, O_RDONLY | O_CLOEXEC);
+        io->syscalls++;
+        if (fds[c] < 0) {
+            sysfs_close_slot(fds, io);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Open statistics descriptors for every interface in the table
+ * Interfaces that do not exist yet are retried on each sample
+ */
+bool sysfs_open(sysfs_reader_t *reader, const iface_table_t *table) {
+    reader->count = table->count;
+    reader->io = (io_counters_t){0};
+    reader->fds = malloc(table->count * sizeof(*reader->fds));
+    if (!reader->fds) {
+        fprintf(stderr, "Error: Cannot allocate sysfs descriptors: %s\n", strerror(errno));
+        reader->count = 0;
+        return false;
+    }
+
+    for (size_t i = 0; i < reader->count; i++) {
+        for (int c = 0; c < SYSFS_COUNTERS; c++) {
+            reader->fds[i][c] = -1;
+        }
+        sysfs_open_slot(reader->fds[i], table->slots[i].current.interface, &reader->io);
+    }
+    return true;
+}
+
+void sysfs_close(sysfs_reader_t *reader) {
+    for (size_t i = 0; i < reader->count; i++) {
+        sysfs_close_slot(reader->fds[i], &reader->io);
+    }
+    free(reader->fds);
+    reader->fds = NULL;
+    reader->count = 0;
+}
+
+/**
+ * Re-read one counter file from offset 0
+ * Returns false if the read fails or the file holds no number that fits
+ * in 64 bits
+ */
+static bool sysfs_read_counter(int fd, uint64_t *value, io_counters_t *io) {
+    char buf[32];
+    ssize_t n;
+    do {
+        n = pread(fd, buf, sizeof(buf), 0);
+        io->syscalls++;
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        return false;
+    }
+    io->bytes += (uint64_t)n;
+
+    uint64_t v = 0;
+    ssize_t i = 0;
+    for (; i < n && (unsigned)(buf[i] - '0') <= 9; i++) {
+        unsigned d = (unsigned)(buf[i] - '0');
+        /* Reject values past UINT64_MAX, as the /proc/net/dev parser does */
+        if (v > (UINT64_MAX - d) / 10) {
+            return false;
+        }
+        v = v * 10 + d;
+    }
+    if (i == 0) {
+        return false;
+    }
+    *value = v;
+    return true;
+}
+
+static void sysfs_store(net_stats_t *stats, const uint64_t *values) {
+    stats->rx_bytes = values[0];
+    stats->rx_packets = values[1];
+    stats->rx_errors = values[2];
+    /* Match the /proc/net/dev drop column: dropped plus missed */
+    stats->rx_drops = values[3] + values[4];
+    stats->tx_bytes = values[5];
+    stats->tx_packets = values[6];
+    stats->tx_errors = values[7];
+    stats->tx_drops = values[8];
+    stats->valid = true;
+}
+
+/**
+ * pread() the counters of every watched interface from its open descriptors
+ * An interface whose files vanish is closed and reopened on later samples,
+ * which also picks up a new device registered under the same name
+ * Returns true; missing interfaces are reported through their seen flag
+ */
+bool sysfs_read_stats(sysfs_reader_t *reader, iface_table_t *table) {
+    iface_table_begin_sample(table);
+
+    for (size_t i = 0; i < reader->count && i < table->count; i++) {
+        int *fds = reader->fds[i];
+        iface_slot_t *slot = &table->slots[i];
+
+        if (fds[0] < 0 && !sysfs_open_slot(fds, slot->current.interface, &reader->io)) {
+            continue;
+        }
+
+        uint64_t values[SYSFS_COUNTERS];
+        bool ok = true;
+        for (int c = 0; c < SYSFS_COUNTERS && ok; c++) {
+            ok = sysfs_read_counter(fds[c], &values[c], &reader->io);
+        }
+        if (!ok) {
+            sysfs_close_slot(fds, &reader->io);
+            continue;
+        }
+
+        sysfs_store(&slot->current, values);
+        slot->seen = true;
+    }
+
+    iface_table_stamp(table);
+    return true;
+}
+
+/**
+ * Count the network interfaces registered on the system
+ */
+size_t sysfs_count_interfaces(void) {
+    DIR *dir = opendir(SYS_CLASS_NET);
+    if (!dir) {
+        return 0;
+    }
+
+    size_t count = 0;
+    const struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] != '.') {
+            count++;
+        }
+    }
+    closedir(dir);
+    return count;
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SYSFS_H
+#define SYSFS_H
+
+#include <stddef.h>
+
+#include "netstat_monitor.h"
+#include "iface_table.h"
+
+#define SYS_CLASS_NET "/sys/class/net"
+#define SYSFS_COUNTERS 9
+
+/*
+ * Watching fewer than one in SYSFS_AUTO_RATIO of the system's interfaces
+ * makes per-counter sysfs reads cheaper than scanning all of /proc/net/dev
+ */
+#define SYSFS_AUTO_RATIO 16
+
+typedef struct {
+    int (*fds)[SYSFS_COUNTERS];
+    size_t count;
+    io_counters_t io;
+} sysfs_reader_t;
+
+bool sysfs_open(sysfs_reader_t *reader, const iface_table_t *table);
+void sysfs_close(sysfs_reader_t *reader);
+bool sysfs_read_stats(sysfs_reader_t *reader, iface_table_t *table);
+size_t sysfs_count_interfaces(void);
+
+#endif /* SYSFS_H */
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <string.h>
+
+#include "timestamp.h"
+
+/* "YYYY-MM-DD HH:MM:" precedes the seconds */
+#define SECONDS_OFFSET 17
+
+void timestamp_cache_init(timestamp_cache_t *cache, bool millis) {
+    memset(cache, 0, sizeof(*cache));
+    cache->millis = millis;
+}
+
+/**
+ * Format now as "%Y-%m-%d %H:%M:%S", plus ".mmm" in millisecond mode
+ * The returned text belongs to the cache and is valid until the next call
+ */
+const char *timestamp_format(timestamp_cache_t *cache, const struct timespec *now) {
+    if (!cache->valid || now->tv_sec < cache->minute_start ||
+        now->tv_sec >= cache->minute_start + 60) {
+        struct tm tm_info;
+        if (!localtime_r(&now->tv_sec, &tm_info) ||
+            strftime(cache->text, sizeof(cache->text), "%Y-%m-%d %H:%M:%S", &tm_info) !=
+                SECONDS_OFFSET + 2) {
+            cache->valid = false;
+            strcpy(cache->text, "?");
+            return cache->text;
+        }
+        /* Zone offsets change on minute boundaries, so the prefix holds for the minute */
+        cache->minute_start = now->tv_sec - tm_info.tm_sec;
+        cache->valid = true;
+    }
+
+    unsigned seconds = (unsigned)(now->tv_sec - cache->minute_start);
+    char *p = cache->text + SECONDS_OFFSET;
+    p[0] = (char)('0' + seconds / 10);
+    p[1] = (char)('0' + seconds % 10);
+    if (cache->millis) {
+        unsigned ms = (unsigned)(now->tv_nsec / 1000000);
+        p[2] = '.';
+        p[3] = (char)('0' + ms / 100);
+        p[4] = (char)('0' + ms / 10 % 10);
+        p[5] = (char)('0' + ms % 10);
+        p[6] = '\0';
+    }
+    return cache->text;
+}
+
+/**
+ * Format the current CLOCK_REALTIME time
+ */
+const char *timestamp_now(timestamp_cache_t *cache) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return timestamp_format(cache, &now);
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+#include <stdbool.h>
+#include <time.h>
+
+#define TIMESTAMP_WIDTH 19
+#define TIMESTAMP_MILLIS_WIDTH 23
+
+/*
+ * Wall-clock text for the Timestamp column. localtime_r() and strftime()
+ * run only when the minute changes; the seconds and milliseconds are
+ * patched into the cached text in place
+ */
+typedef struct {
+    char text[32];
+    time_t minute_start;
+    bool valid;
+    bool millis;
+} timestamp_cache_t;
+
+void timestamp_cache_init(timestamp_cache_t *cache, bool millis);
+const char *timestamp_format(timestamp_cache_t *cache, const struct timespec *now);
+const char *timestamp_now(timestamp_cache_t *cache);
+
+static inline int timestamp_width(const timestamp_cache_t *cache) {
+    return cache->millis ? TIMESTAMP_MILLIS_WIDTH : TIMESTAMP_WIDTH;
+}
+
+#endif /* TIMESTAMP_H */
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+/*
+ * Minimal harness for the unit tests: CHECK() reports a failed
+ * condition and carries on, and test_summary() gives the exit status
+ * Output written to a descriptor while a capture is active lands in a
+ * temporary file, returned as a string by capture_end()
+ */
+static int test_checks;
+static int test_failures;
+
+#define CHECK(cond)                                                               \
+    do {                                                                          \
+        test_checks++;                                                            \
+        if (!(cond)) {                                                            \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            test_failures++;                                                      \
+        }                                                                         \
+    } while (0)
+
+static inline int test_summary(const char *name) {
+    printf("%s: %d checks, %d failed\n", name, test_checks, test_failures);
+    return test_failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+typedef struct {
+    int fd;
+    int saved;
+    FILE *file;
+} capture_t;
+
+static inline void capture_begin(capture_t *capture, int fd) {
+    fflush(NULL);
+    capture->fd = fd;
+    capture->file = tmpfile();
+    capture->saved = capture->file ? dup(fd) : -1;
+    if (capture->saved < 0 || dup2(fileno(capture->file), fd) < 0) {
+        perror("capture");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Restore the descriptor and return what was written to it; the caller
+ * frees the string
+ */
+static inline char *capture_end(capture_t *capture) {
+    fflush(NULL);
+    dup2(capture->saved, capture->fd);
+    close(capture->saved);
+
+    /* Written through the descriptor, so stdio's position means nothing */
+    off_t size = lseek(fileno(capture->file), 0, SEEK_END);
+    char *text = calloc(1, (size_t)(size > 0 ? size : 0) + 1);
+    if (!text) {
+        perror("capture");
+        exit(EXIT_FAILURE);
+    }
+    if (size > 0 && pread(fileno(capture->file), text, (size_t)size, 0) != size) {
+        perror("capture");
+        exit(EXIT_FAILURE);
+    }
+    fclose(capture->file);
+    return text;
+}
+
+/**
+ * Number of times needle occurs in haystack
+ */
+static inline size_t count_of(const char *haystack, const char *needle) {
+    size_t n = 0;
+    for (const char *p = strstr(haystack, needle); p; p = strstr(p + 1, needle)) {
+        n++;
+    }
+    return n;
+}
+
+#endif /* TEST_H */
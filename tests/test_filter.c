@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "test.h"
+#include "iface_filter.h"
+#include "iface_table.h"
+
+static void test_empty(void) {
+    iface_filter_t filter = {0};
+    CHECK(iface_filter_empty(&filter));
+    CHECK(iface_filter_match(&filter, "eth0"));
+    CHECK(iface_filter_match(&filter, ""));
+    iface_filter_free(&filter);
+}
+
+static void test_globs(void) {
+    iface_filter_t filter = {0};
+    CHECK(iface_filter_add(&filter, "eth*", false));
+    CHECK(iface_filter_add(&filter, "veth[0-3]", false));
+    CHECK(iface_filter_add(&filter, "eth9?", true));
+    CHECK(!iface_filter_empty(&filter));
+
+    CHECK(iface_filter_match(&filter, "eth0"));
+    CHECK(iface_filter_match(&filter, "eth"));
+    CHECK(iface_filter_match(&filter, "eth9"));
+    CHECK(!iface_filter_match(&filter, "eth90"));
+    CHECK(iface_filter_match(&filter, "eth900"));
+    CHECK(iface_filter_match(&filter, "veth3"));
+    CHECK(!iface_filter_match(&filter, "veth4"));
+    CHECK(!iface_filter_match(&filter, "veth31"));
+    CHECK(!iface_filter_match(&filter, "xeth0"));
+    CHECK(!iface_filter_match(&filter, "lo"));
+    iface_filter_free(&filter);
+    CHECK(iface_filter_empty(&filter));
+}
+
+static void test_regex(void) {
+    iface_filter_t filter = {0};
+    CHECK(iface_filter_add(&filter, "re:bond[0-9]+|team.", false));
+    CHECK(iface_filter_add(&filter, "re:bond1[0-9]", true));
+
+    /* Anchored at both ends, around the whole alternation */
+    CHECK(iface_filter_match(&filter, "bond0"));
+    CHECK(iface_filter_match(&filter, "bond123"));
+    CHECK(!iface_filter_match(&filter, "bond"));
+    CHECK(!iface_filter_match(&filter, "xbond0"));
+    CHECK(!iface_filter_match(&filter, "bond0x"));
+    CHECK(iface_filter_match(&filter, "teamA"));
+    CHECK(!iface_filter_match(&filter, "teamAB"));
+    CHECK(!iface_filter_match(&filter, "bond12"));
+    CHECK(iface_filter_match(&filter, "bond1"));
+    iface_filter_free(&filter);
+}
+
+static void test_exclude_only(void) {
+    iface_filter_t filter = {0};
+    CHECK(iface_filter_add(&filter, "lo", true));
+    CHECK(iface_filter_add(&filter, "re:docker.*", true));
+    CHECK(iface_filter_match(&filter, "eth0"));
+    CHECK(iface_filter_match(&filter, "lo0"));
+    CHECK(!iface_filter_match(&filter, "lo"));
+    CHECK(!iface_filter_match(&filter, "docker0"));
+    iface_filter_free(&filter);
+}
+
+static void test_invalid(void) {
+    iface_filter_t filter = {0};
+    capture_t err;
+
+    capture_begin(&err, STDERR_FILENO);
+    bool added = iface_filter_add(&filter, "re:(eth", false);
+    char *errors = capture_end(&err);
+    CHECK(!added);
+    CHECK(strstr(errors, "Error: Invalid regex '(eth'") != NULL);
+    CHECK(filter.include_count == 0);
+    free(errors);
+    iface_filter_free(&filter);
+}
+
+/**
+ * Discovery asks the filter once per new name; renames out of the
+ * selection remove the slot
+ */
+static void test_discovery(void) {
+    iface_filter_t filter = {0};
+    iface_table_t table = {0};
+    CHECK(iface_filter_add(&filter, "eth*", false));
+    table.watch_all = true;
+    table.filter = &filter;
+
+    iface_slot_t *eth = iface_table_discover(&table, "eth0", 4);
+    CHECK(eth != NULL && eth->discovered);
+    CHECK(iface_table_discover(&table, "lo", 2) == NULL);
+    CHECK(table.rejected_count == 1);
+    CHECK(iface_table_discover(&table, "lo", 2) == NULL);
+    CHECK(table.rejected_count == 1);
+    CHECK(table.count == 1);
+
+    iface_table_rename(&table, eth, "wan0", 4);
+    CHECK(eth->removed && eth->spare);
+    CHECK(eth->changes == (IFACE_CHANGE_REMOVED | IFACE_CHANGE_RENAMED |
+                           IFACE_CHANGE_DESELECTED));
+    CHECK(strcmp(eth->current.interface, "wan0") == 0);
+    CHECK(iface_table_find(&table, "eth0") == NULL);
+    CHECK(iface_table_discover(&table, "wan0", 4) == NULL);
+
+    /* The spare id goes to the next selected name */
+    iface_table_clear_changes(&table);
+    iface_slot_t *reused = iface_table_discover(&table, "eth1", 4);
+    CHECK(reused == eth);
+    CHECK(!reused->removed && !reused->spare);
+    CHECK(reused->changes == (IFACE_CHANGE_RENAMED | IFACE_CHANGE_RESTARTED));
+    CHECK(table.count == 1);
+
+    iface_table_free(&table);
+    iface_filter_free(&filter);
+}
+
+int main(void) {
+    test_empty();
+    test_globs();
+    test_regex();
+    test_exclude_only();
+    test_invalid();
+    test_discovery();
+    return test_summary("test_filter");
+}
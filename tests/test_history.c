@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "netstat_monitor.h"
+#include "iface_soa.h"
+#include "history.h"
+
+#define IFACES 3
+
+static char path[] = "/tmp/netstat_monitor_test_history_XXXXXX";
+
+static void fill_view(iface_soa_t *view, uint64_t value, int64_t time_ns) {
+    for (size_t i = 0; i < view->count; i++) {
+        for (int c = 0; c < IFACE_COUNTERS; c++) {
+            view->current[c][i] = value;
+        }
+        view->time_ns[i] = time_ns;
+        view->seen[i] = 1;
+    }
+}
+
+static void init_view(iface_soa_t *view) {
+    memset(view, 0, sizeof(*view));
+    CHECK(iface_soa_add(view, "eth0", 4));
+    CHECK(iface_soa_add(view, "eth1", 4));
+    CHECK(iface_soa_add(view, "lo", 2));
+}
+
+static history_slot_t *slot_at(history_t *history, uint64_t tick) {
+    history_header_t *header = history->header;
+    char *base = (char *)header + header->header_size;
+    return (history_slot_t *)(base + (size_t)(tick % header->slot_count) * header->slot_size);
+}
+
+static void bump(_Atomic uint64_t *seq) {
+    atomic_fetch_add(seq, 1);
+}
+
+static bool dump(char **rows, char **errors) {
+    capture_t out, err;
+    capture_begin(&out, STDOUT_FILENO);
+    capture_begin(&err, STDERR_FILENO);
+    bool ok = history_dump(path, OUTPUT_JSON);
+    *errors = capture_end(&err);
+    *rows = capture_end(&out);
+    return ok;
+}
+
+static bool open_history(history_t *history, const iface_soa_t *view) {
+    return history_open(history, path, 10 * NSEC_PER_SEC, NSEC_PER_SEC, view, IFACES);
+}
+
+/**
+ * A slot whose seq stays odd is skipped with a warning, and the tick
+ * after it gets no rates; an odd name table seq fails the dump. Neither
+ * hangs the reader
+ */
+static void test_history(void) {
+    iface_soa_t view;
+    history_t history;
+    char *rows, *errors;
+
+    init_view(&view);
+    CHECK(open_history(&history, &view));
+    for (int tick = 0; tick < 3; tick++) {
+        struct timespec wall = {.tv_sec = 1700000000 + tick};
+        fill_view(&view, (uint64_t)tick * 100, 0);
+        history_append(&history, &view, &wall);
+    }
+
+    CHECK(dump(&rows, &errors));
+    CHECK(errors[0] == '\0');
+    CHECK(count_of(rows, "\n") == 3 * IFACES);
+    CHECK(count_of(rows, "\"delta\":null") == IFACES);
+    CHECK(count_of(rows, "\"elapsed\":1.000") == 2 * IFACES);
+    free(rows);
+    free(errors);
+
+    bump(&slot_at(&history, 1)->seq);
+    CHECK(dump(&rows, &errors));
+    CHECK(strstr(errors, "Skipping tick 1: slot being written or corrupt") != NULL);
+    CHECK(count_of(rows, "\n") == 2 * IFACES);
+    CHECK(count_of(rows, "\"delta\":null") == 2 * IFACES);
+    CHECK(count_of(rows, "\"time\":1700000001.") == 0);
+    free(rows);
+    free(errors);
+
+    bump(&history.header->seq);
+    CHECK(!dump(&rows, &errors));
+    CHECK(strstr(errors, "is being written or corrupt") != NULL);
+    CHECK(rows[0] == '\0');
+    free(rows);
+    free(errors);
+
+    /* Reopened by a new writer, odd seqs are rounded up and the torn tick dropped */
+    history_close(&history);
+    CHECK(open_history(&history, &view));
+    CHECK((atomic_load(&history.header->seq) & 1) == 0);
+    CHECK((atomic_load(&slot_at(&history, 1)->seq) & 1) == 0);
+    CHECK(dump(&rows, &errors));
+    CHECK(errors[0] == '\0');
+    CHECK(count_of(rows, "\n") == 2 * IFACES);
+    free(rows);
+    free(errors);
+
+    history_close(&history);
+    iface_soa_free(&view);
+}
+
+int main(void) {
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        perror("mkstemp");
+        return EXIT_FAILURE;
+    }
+    close(fd);
+
+    test_history();
+
+    unlink(path);
+    return test_summary("test_history");
+}
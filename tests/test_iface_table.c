@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "test.h"
+#include "iface_table.h"
+
+#define MANY 1000
+
+/**
+ * Every entry of an open-addressing index must be reachable from its
+ * home bucket without crossing an empty one; a removal that left a hole
+ * instead of shifting later entries back breaks this
+ */
+static bool index_intact(const iface_bucket_t *index, size_t mask) {
+    for (size_t j = 0; j <= mask; j++) {
+        if (!index[j].slot) {
+            continue;
+        }
+        for (size_t i = index[j].hash & mask; i != j; i = (i + 1) & mask) {
+            if (!index[i].slot) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static size_t index_entries(const iface_bucket_t *index, size_t mask) {
+    size_t n = 0;
+    for (size_t i = 0; i <= mask; i++) {
+        n += index[i].slot != 0;
+    }
+    return n;
+}
+
+static void name_of(char *name, size_t i) {
+    snprintf(name, MAX_IFACE_LEN, "veth%zu", i);
+}
+
+static void test_named(void) {
+    iface_table_t table = {0};
+    CHECK(iface_table_add(&table, "eth0"));
+    CHECK(iface_table_add(&table, "lo"));
+
+    CHECK(iface_table_find(&table, "eth0") == &table.slots[0]);
+    CHECK(iface_table_find(&table, "lo") == &table.slots[1]);
+    CHECK(iface_table_find(&table, "eth") == NULL);
+    CHECK(iface_table_find(&table, "eth00") == NULL);
+    /* Spans need no terminator */
+    CHECK(iface_table_find_n(&table, "lo: 123", 2) == &table.slots[1]);
+    CHECK(iface_table_find_n(&table, "eth0123", 4) == &table.slots[0]);
+    /* Not watching all, unknown names are not added */
+    CHECK(iface_table_discover(&table, "eth1", 4) == NULL);
+    CHECK(table.count == 2);
+
+    /* A named slot keeps its name and id across removal */
+    iface_table_remove(&table, &table.slots[0]);
+    CHECK(table.slots[0].removed && !table.slots[0].spare);
+    CHECK(iface_table_find(&table, "eth0") == &table.slots[0]);
+    iface_table_clear_changes(&table);
+    CHECK(iface_table_discover(&table, "eth0", 4) == &table.slots[0]);
+    CHECK(!table.slots[0].removed);
+    CHECK(table.slots[0].changes == IFACE_CHANGE_RESTARTED);
+    iface_table_free(&table);
+}
+
+/**
+ * Grow the name index past several rebuilds, then remove every other
+ * entry: the rest stay reachable with no tombstones left behind, and new
+ * names take the freed ids
+ */
+static void test_name_index(void) {
+    iface_table_t table = {0};
+    char name[MAX_IFACE_LEN];
+    table.watch_all = true;
+
+    for (size_t i = 0; i < MANY; i++) {
+        name_of(name, i);
+        CHECK(iface_table_discover(&table, name, strlen(name)) == &table.slots[i]);
+    }
+    CHECK(table.count == MANY);
+    CHECK(index_intact(table.by_name, table.index_mask));
+
+    for (size_t i = 0; i < MANY; i += 2) {
+        iface_table_remove(&table, &table.slots[i]);
+    }
+    CHECK(table.spare_count == MANY / 2);
+    CHECK(index_intact(table.by_name, table.index_mask));
+    CHECK(index_entries(table.by_name, table.index_mask) == MANY / 2);
+    for (size_t i = 0; i < MANY; i++) {
+        name_of(name, i);
+        iface_slot_t *slot = iface_table_find(&table, name);
+        CHECK(i % 2 ? slot == &table.slots[i] : slot == NULL);
+    }
+
+    for (size_t i = MANY; i < MANY + MANY / 2; i++) {
+        name_of(name, i);
+        iface_slot_t *slot = iface_table_discover(&table, name, strlen(name));
+        CHECK(slot != NULL && (slot - table.slots) % 2 == 0);
+    }
+    CHECK(table.count == MANY);
+    CHECK(table.spare_count == 0);
+    CHECK(index_intact(table.by_name, table.index_mask));
+    for (size_t i = 1; i < MANY + MANY / 2; i += i < MANY ? 2 : 1) {
+        name_of(name, i);
+        iface_slot_t *slot = iface_table_find(&table, name);
+        CHECK(slot != NULL && strcmp(slot->current.interface, name) == 0);
+    }
+    iface_table_free(&table);
+}
+
+/**
+ * Ifindexes 16 apart share a home bucket in the initial 16-bucket index,
+ * so removing the head of the cluster has to shift the others back
+ */
+static void test_ifindex_cluster(void) {
+    static const int ifindexes[] = {1, 17, 33, 49, 2};
+    size_t n = sizeof(ifindexes) / sizeof(ifindexes[0]);
+    iface_table_t table = {0};
+    char name[MAX_IFACE_LEN];
+
+    for (size_t i = 0; i < n; i++) {
+        name_of(name, i);
+        CHECK(iface_table_add(&table, name));
+        iface_table_set_ifindex(&table, &table.slots[i], ifindexes[i]);
+    }
+    CHECK(table.index_mask == 15);
+    for (size_t i = 0; i < n; i++) {
+        CHECK(iface_table_find_ifindex(&table, ifindexes[i]) == &table.slots[i]);
+    }
+
+    iface_table_set_ifindex(&table, &table.slots[0], 0);
+    CHECK(table.slots[0].ifindex == 0);
+    CHECK(iface_table_find_ifindex(&table, 1) == NULL);
+    CHECK(index_intact(table.by_ifindex, table.index_mask));
+    CHECK(index_entries(table.by_ifindex, table.index_mask) == n - 1);
+    for (size_t i = 1; i < n; i++) {
+        CHECK(iface_table_find_ifindex(&table, ifindexes[i]) == &table.slots[i]);
+    }
+
+    /* Taking an ifindex from another slot leaves that slot without one */
+    iface_table_set_ifindex(&table, &table.slots[1], 33);
+    CHECK(table.slots[1].ifindex == 33 && table.slots[2].ifindex == 0);
+    CHECK(iface_table_find_ifindex(&table, 33) == &table.slots[1]);
+    CHECK(iface_table_find_ifindex(&table, 17) == NULL);
+    CHECK(iface_table_find_ifindex(&table, 49) == &table.slots[3]);
+    CHECK(index_intact(table.by_ifindex, table.index_mask));
+    CHECK(index_entries(table.by_ifindex, table.index_mask) == 3);
+
+    /* Removal drops the ifindex; rebuilding on growth keeps the rest */
+    iface_table_remove(&table, &table.slots[3]);
+    CHECK(iface_table_find_ifindex(&table, 49) == NULL);
+    for (size_t i = n; i < 64; i++) {
+        name_of(name, i);
+        CHECK(iface_table_add(&table, name));
+        iface_table_set_ifindex(&table, &table.slots[i], (int)(i * 16 + 1));
+    }
+    CHECK(table.index_mask > 15);
+    CHECK(index_intact(table.by_ifindex, table.index_mask));
+    CHECK(iface_table_find_ifindex(&table, 33) == &table.slots[1]);
+    CHECK(iface_table_find_ifindex(&table, 2) == &table.slots[4]);
+    CHECK(iface_table_find_ifindex(&table, 63 * 16 + 1) == &table.slots[63]);
+    iface_table_free(&table);
+}
+
+/**
+ * A rename moves the slot in the name index; a slot still holding the
+ * new name is stale and loses it
+ */
+static void test_rename(void) {
+    iface_table_t table = {0};
+    table.watch_all = true;
+
+    iface_slot_t *a = iface_table_discover(&table, "eth0", 4);
+    iface_slot_t *b = iface_table_discover(&table, "eth1", 4);
+    CHECK(a && b);
+    iface_table_clear_changes(&table);
+
+    CHECK(iface_table_rename(&table, a, "wan0", 4) == a);
+    CHECK(a->changes == IFACE_CHANGE_RENAMED);
+    CHECK(iface_table_find(&table, "wan0") == a);
+    CHECK(iface_table_find(&table, "eth0") == NULL);
+
+    CHECK(iface_table_rename(&table, b, "wan0", 4) == b);
+    CHECK(iface_table_find(&table, "wan0") == b);
+    CHECK(a->removed && a->spare);
+    CHECK(index_intact(table.by_name, table.index_mask));
+    CHECK(index_entries(table.by_name, table.index_mask) == 1);
+
+    /* Renaming to its own name changes nothing */
+    iface_table_clear_changes(&table);
+    iface_table_rename(&table, b, "wan0", 4);
+    CHECK(b->changes == 0);
+    iface_table_free(&table);
+}
+
+/**
+ * A link renamed to a name given on the command line is taken over by
+ * that slot, which keeps its name and starts a new baseline; the slot
+ * the link had is removed
+ */
+static void test_rename_to_named(void) {
+    iface_table_t table = {0};
+    CHECK(iface_table_add(&table, "eth0"));
+    CHECK(iface_table_add(&table, "eth5"));
+    iface_slot_t *named = &table.slots[0];
+    iface_slot_t *other = &table.slots[1];
+    table.watch_all = true;
+
+    /* Waiting for its link, then a discovered link is renamed to it */
+    iface_table_remove(&table, named);
+    iface_slot_t *found = iface_table_discover(&table, "veth9", 5);
+    CHECK(found && found->discovered);
+    iface_table_set_ifindex(&table, found, 7);
+    iface_table_clear_changes(&table);
+
+    CHECK(iface_table_rename(&table, found, "eth0", 4) == named);
+    CHECK(!named->removed && !named->spare && !named->discovered);
+    CHECK(strcmp(named->current.interface, "eth0") == 0);
+    CHECK(named->ifindex == 7 && iface_table_find_ifindex(&table, 7) == named);
+    CHECK(named->changes == IFACE_CHANGE_RESTARTED);
+    CHECK(iface_table_find(&table, "eth0") == named);
+    CHECK(found->removed && found->spare && found->ifindex == 0);
+    CHECK(iface_table_find(&table, "veth9") == NULL);
+
+    /* A named slot renamed onto another keeps its own name and waits */
+    iface_table_set_ifindex(&table, other, 5);
+    iface_table_clear_changes(&table);
+    CHECK(iface_table_rename(&table, other, "eth0", 4) == named);
+    CHECK(named->ifindex == 5 && iface_table_find_ifindex(&table, 7) == NULL);
+    CHECK(other->removed && !other->spare && other->ifindex == 0);
+    CHECK(strcmp(other->current.interface, "eth5") == 0);
+    CHECK(iface_table_find(&table, "eth5") == other);
+    CHECK(iface_table_find(&table, "eth0") == named);
+    CHECK(index_intact(table.by_name, table.index_mask));
+    CHECK(index_intact(table.by_ifindex, table.index_mask));
+    CHECK(index_entries(table.by_name, table.index_mask) == 2);
+    iface_table_free(&table);
+}
+
+int main(void) {
+    test_named();
+    test_name_index();
+    test_ifindex_cluster();
+    test_rename();
+    test_rename_to_named();
+    return test_summary("test_iface_table");
+}
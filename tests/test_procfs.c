@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "test.h"
+#include "netstat_monitor.h"
+#include "procfs.h"
+#include "iface_table.h"
+
+#define PAGE 4096
+
+static const char *scanner_names[] = {"scalar", "sse2", "avx2"};
+
+static const char proc_net_dev[] =
+    "Inter-|   Receive                                                |  Transmit\n"
+    " face |bytes    packets errs drop fifo frame compressed multicast|"
+    "bytes    packets errs drop fifo colls carrier compressed\n"
+    "    lo: 18446744073709551615 1 2 3 0 0 0 0 18446744073709551614 4 5 6 0 0 0 0\n"
+    "  big0: 18446744073709551616 1 2 3 0 0 0 0 0 4 5 6 0 0 0 0\n"
+    "  big1: 99999999999999999999 1 2 3 0 0 0 0 0 4 5 6 0 0 0 0\n"
+    "  big2: 100000000000000000000 1 2 3 0 0 0 0 0 4 5 6 0 0 0 0\n"
+    "  big3: 1 2 3 4 0 0 0 0 18446744073709551616 4 5 6 0 0 0 0\n"
+    "veth0123456:12345678901234567890    7    8    9    0    0    0    0 "
+    "   10   11   12   13    0    0    0    0\n"
+    "short0: 1 2 3\n"
+    " junk0: 1x 2 3 4 0 0 0 0 5 6 7 8 0 0 0 0\n"
+    "  eth0: 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0";
+
+static const iface_slot_t *slot_of(iface_table_t *table, const char *name) {
+    iface_slot_t *slot = iface_table_find(table, name);
+    CHECK(slot != NULL);
+    return slot;
+}
+
+/**
+ * Values past UINT64_MAX, a name running into its first counter, short
+ * and malformed lines and a last line without a newline
+ */
+static void test_parse_buffer(const procfs_scanner_t *scanner) {
+    iface_table_t table = {0};
+    table.watch_all = true;
+
+    procfs_parse_buffer(scanner, proc_net_dev, &table);
+    CHECK(table.count == 9);
+
+    const iface_slot_t *lo = slot_of(&table, "lo");
+    CHECK(lo->seen);
+    CHECK(lo->current.rx_bytes == UINT64_MAX);
+    CHECK(lo->current.rx_packets == 1 && lo->current.rx_errors == 2 && lo->current.rx_drops == 3);
+    CHECK(lo->current.tx_bytes == UINT64_MAX - 1);
+    CHECK(lo->current.tx_packets == 4 && lo->current.tx_errors == 5 && lo->current.tx_drops == 6);
+
+    CHECK(!slot_of(&table, "big0")->seen);
+    CHECK(!slot_of(&table, "big1")->seen);
+    CHECK(!slot_of(&table, "big2")->seen);
+    CHECK(!slot_of(&table, "big3")->seen);
+    CHECK(!slot_of(&table, "short0")->seen);
+    CHECK(!slot_of(&table, "junk0")->seen);
+
+    const iface_slot_t *veth = slot_of(&table, "veth0123456");
+    CHECK(veth->seen);
+    CHECK(veth->current.rx_bytes == UINT64_C(12345678901234567890));
+    CHECK(veth->current.tx_bytes == 10 && veth->current.tx_drops == 13);
+
+    const iface_slot_t *eth = slot_of(&table, "eth0");
+    CHECK(eth->seen && eth->current.rx_bytes == 0 && eth->current.tx_drops == 0);
+
+    /* Counters wrapping to zero between two reads */
+    procfs_parse_buffer(scanner,
+                        "header\nheader\n"
+                        "    lo: 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0\n", &table);
+    CHECK(lo->seen && lo->current.rx_bytes == 0 && lo->current.tx_bytes == 0);
+    CHECK(!eth->seen);
+
+    iface_table_free(&table);
+}
+
+/**
+ * Counters of every line, placed at each offset around a page boundary
+ * so that the vector scanners take both their wide and their bytewise
+ * paths, parse as the scalar scanner does
+ */
+static void test_page_boundary(const procfs_scanner_t *scanner) {
+    static const char *fields[] = {
+        "18446744073709551615 1 2 3 0 0 0 0 18446744073709551615 4 5 6 0 0 0 0\n",
+        " 123 456  789 0 0 0 0 0 1 2 3 4 0 0 0 0",
+        "18446744073709551616 1 2 3 0 0 0 0 0 4 5 6 0 0 0 0\n",
+        "100000000000000000000 1 2 3 0 0 0 0 0 4 5 6 0 0 0 0\n",
+        "1 2 3 4 0 0 0 0 5 6 7 8 0 0 0 99999999999999999999\n",
+        "1 2 3\n",
+        "1 2 3 4 0 0 0 0 5 6 7 8 0 0 0 0x\n",
+    };
+    char *buf = aligned_alloc(PAGE, 2 * PAGE);
+    CHECK(buf != NULL);
+    memset(buf, 'z', 2 * PAGE);
+
+    for (size_t f = 0; f < sizeof(fields) / sizeof(fields[0]); f++) {
+        size_t len = strlen(fields[f]);
+        for (size_t offset = PAGE - len - 8; offset < PAGE + 8; offset++) {
+            net_stats_t expected = {0}, parsed = {0};
+            memcpy(buf + offset, fields[f], len + 1);
+            const char *want = procfs_scanner_scalar.parse_counters(buf + offset, &expected);
+            const char *got = scanner->parse_counters(buf + offset, &parsed);
+            CHECK(got == want);
+            if (want) {
+                CHECK(memcmp(&parsed.rx_bytes, &expected.rx_bytes, 8 * sizeof(uint64_t)) == 0);
+            }
+        }
+        /* Only the first two are well formed */
+        net_stats_t stats = {0};
+        CHECK((procfs_scanner_scalar.parse_counters(fields[f], &stats) != NULL) == (f < 2));
+    }
+    free(buf);
+}
+
+int main(void) {
+    for (size_t i = 0; i < sizeof(scanner_names) / sizeof(scanner_names[0]); i++) {
+        const procfs_scanner_t *scanner = procfs_scanner_get(scanner_names[i]);
+        if (!scanner) {
+            printf("test_procfs: %s scanner not supported here, skipped\n", scanner_names[i]);
+            continue;
+        }
+        test_parse_buffer(scanner);
+        test_page_boundary(scanner);
+    }
+    return test_summary("test_procfs");
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "test.h"
+#include "netstat_monitor.h"
+#include "iface_soa.h"
+#include "rate.h"
+
+static const char *kernel_names[] = {"scalar", "avx2"};
+
+/**
+ * The rate kernels agree with safe_delta() on counters that wrap
+ */
+static void test_wrap(const iface_soa_kernel_t *kernel) {
+    static const uint64_t pairs[][2] = {
+        {UINT32_MAX - 5, 10},
+        {UINT32_MAX, 0},
+        {UINT64_C(1) << 32, 0},
+        {UINT64_MAX, 0},
+        {UINT64_MAX - 1, UINT64_MAX},
+        {0, 0},
+        {5, 5},
+        {100, 7},
+        {UINT64_MAX, UINT64_MAX},
+        {1, UINT64_MAX},
+        {(UINT64_C(1) << 63) + 1, (UINT64_C(1) << 63) - 1},
+    };
+    size_t n = sizeof(pairs) / sizeof(pairs[0]);
+    iface_soa_t soa = {0};
+
+    for (size_t i = 0; i < n; i++) {
+        CHECK(iface_soa_add(&soa, "x", 1));
+    }
+    soa.kernel = kernel;
+    for (size_t i = 0; i < n; i++) {
+        for (int c = 0; c < IFACE_COUNTERS; c++) {
+            soa.previous[c][i] = pairs[i][0];
+            soa.current[c][i] = pairs[i][1];
+        }
+        soa.previous_ns[i] = 0;
+        soa.time_ns[i] = (int64_t)NSEC_PER_SEC;
+        soa.seen[i] = 1;
+        soa.has_previous[i] = 1;
+    }
+    iface_soa_compute(&soa);
+
+    for (size_t i = 0; i < n; i++) {
+        uint64_t delta = safe_delta(pairs[i][1], pairs[i][0]);
+        for (int c = 0; c < IFACE_COUNTERS; c++) {
+            CHECK(soa.delta[c][i] == delta);
+            CHECK(soa.rate[c][i] == (double)delta);
+        }
+        CHECK(soa.elapsed[i] == 1.0);
+    }
+    iface_soa_free(&soa);
+}
+
+int main(void) {
+    for (size_t i = 0; i < sizeof(kernel_names) / sizeof(kernel_names[0]); i++) {
+        const iface_soa_kernel_t *kernel = iface_soa_kernel_get(kernel_names[i]);
+        if (!kernel) {
+            printf("test_rates: %s kernel not supported here, skipped\n", kernel_names[i]);
+            continue;
+        }
+        test_wrap(kernel);
+    }
+    return test_summary("test_rates");
+}
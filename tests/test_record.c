@@ -0,0 +1,357 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "netstat_monitor.h"
+#include "output.h"
+#include "record.h"
+
+#define START_SEC 1700000000
+#define MAX_BOUNDARIES 32
+
+static char path[] = "/tmp/netstat_monitor_test_record_XXXXXX";
+
+/* Offsets at which a capture may end: after each record */
+static size_t boundaries[MAX_BOUNDARIES];
+static size_t boundary_count;
+
+static void set_stats(net_stats_t *stats, const char *name, uint64_t rx_bytes, uint64_t base) {
+    memset(stats, 0, sizeof(*stats));
+    snprintf(stats->interface, sizeof(stats->interface), "%s", name);
+    stats->rx_bytes = rx_bytes;
+    stats->rx_packets = base + 1;
+    stats->rx_errors = base + 2;
+    stats->rx_drops = base + 3;
+    stats->tx_bytes = base + 4;
+    stats->tx_packets = base + 5;
+    stats->tx_errors = base + 6;
+    stats->tx_drops = base + 7;
+    stats->valid = true;
+}
+
+static void at(struct timespec *ts, int sec, long ms) {
+    ts->tv_sec = START_SEC + sec;
+    ts->tv_nsec = ms * 1000000L;
+}
+
+static void mark_boundary(output_t *out, int fd) {
+    output_flush(out);
+    boundaries[boundary_count++] = (size_t)lseek(fd, 0, SEEK_CUR);
+}
+
+static void sample(record_state_t *state, output_t *out, int fd, size_t id,
+                   const struct timespec *wall, const net_stats_t *stats) {
+    CHECK(record_write_sample(state, out, id, wall, stats));
+    mark_boundary(out, fd);
+}
+
+/**
+ * Write a capture covering a counter wrapping backwards, a vanished
+ * interface, a rename and an id far beyond the first ones
+ * Returns its size
+ */
+static size_t write_capture(void) {
+    record_state_t state = {0};
+    output_t out;
+    net_stats_t stats;
+    struct timespec start, wall;
+
+    int fd = open(path, O_WRONLY | O_TRUNC);
+    CHECK(fd >= 0);
+    CHECK(output_init(&out, fd, 0));
+    boundary_count = 0;
+
+    at(&start, 0, 0);
+    record_write_header(&state, &out, NSEC_PER_SEC, &start);
+    mark_boundary(&out, fd);
+
+    at(&wall, 1, 250);
+    set_stats(&stats, "eth0", UINT64_MAX - 5, 10);
+    sample(&state, &out, fd, 0, &wall, &stats);
+    set_stats(&stats, "wlan0", 1, 0);
+    sample(&state, &out, fd, 1, &wall, &stats);
+
+    at(&wall, 2, 250);
+    set_stats(&stats, "eth0", 3, 20);
+    sample(&state, &out, fd, 0, &wall, &stats);
+    set_stats(&stats, "wlan0", 101, 100);
+    sample(&state, &out, fd, 1, &wall, &stats);
+
+    record_write_gone(&state, &out, 1);
+    mark_boundary(&out, fd);
+
+    at(&wall, 3, 500);
+    record_rename(&state, 0);
+    set_stats(&stats, "eth0new", 1000, 30);
+    sample(&state, &out, fd, 0, &wall, &stats);
+    set_stats(&stats, "wlan0", 7, 0);
+    sample(&state, &out, fd, 1, &wall, &stats);
+    set_stats(&stats, "veth300", 42, 0);
+    sample(&state, &out, fd, 300, &wall, &stats);
+    /* Nothing is written for an id the decoder would reject */
+    CHECK(!record_write_sample(&state, &out, RECORD_MAX_ID + 1, &wall, &stats));
+
+    CHECK(output_flush(&out));
+    output_free(&out);
+    record_state_free(&state);
+    close(fd);
+    return boundaries[boundary_count - 1];
+}
+
+/**
+ * Decode the capture as JSON Lines, returning stdout and stderr
+ */
+static bool decode(char **rows, char **errors) {
+    capture_t out, err;
+    capture_begin(&out, STDOUT_FILENO);
+    capture_begin(&err, STDERR_FILENO);
+    bool ok = record_decode(path, OUTPUT_JSON);
+    *errors = capture_end(&err);
+    *rows = capture_end(&out);
+    return ok;
+}
+
+static void write_bytes(const void *bytes, size_t len, bool append) {
+    int fd = open(path, O_WRONLY | (append ? O_APPEND : O_TRUNC));
+    CHECK(fd >= 0);
+    CHECK(write(fd, bytes, len) == (ssize_t)len);
+    close(fd);
+}
+
+static size_t put_varint(uint8_t *p, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static void test_round_trip(void) {
+    char *rows, *errors;
+
+    write_capture();
+    CHECK(decode(&rows, &errors));
+    CHECK(errors[0] == '\0');
+
+    CHECK(count_of(rows, "\n") == 7);
+    CHECK(count_of(rows, "\"delta\":null") == 4);
+    CHECK(strstr(rows, "{\"time\":1700000001.250,\"interface\":\"eth0\","
+                       "\"rx_bytes\":18446744073709551610,\"rx_packets\":11,"
+                       "\"rx_errors\":12,\"rx_drops\":13,\"tx_bytes\":14,"
+                       "\"tx_packets\":15,\"tx_errors\":16,\"tx_drops\":17,") != NULL);
+    /* Counters going backwards come back exactly */
+    CHECK(strstr(rows, "{\"time\":1700000002.250,\"interface\":\"eth0\","
+                       "\"rx_bytes\":3,\"rx_packets\":21,") != NULL);
+    CHECK(strstr(rows, "\"interface\":\"wlan0\",\"rx_bytes\":101,\"rx_packets\":101,") != NULL);
+    /* A rename keeps the baseline, a vanished interface loses it */
+    CHECK(strstr(rows, "{\"time\":1700000003.500,\"interface\":\"eth0new\","
+                       "\"rx_bytes\":1000,\"rx_packets\":31,") != NULL);
+    CHECK(strstr(rows, "\"interface\":\"eth0new\",\"rx_bytes\":1000,\"rx_packets\":31,"
+                       "\"rx_errors\":32,\"rx_drops\":33,\"tx_bytes\":34,\"tx_packets\":35,"
+                       "\"tx_errors\":36,\"tx_drops\":37,\"elapsed\":1.250,") != NULL);
+    CHECK(strstr(rows, "\"interface\":\"wlan0\",\"rx_bytes\":7,\"rx_packets\":1,\"rx_errors\":2,"
+                       "\"rx_drops\":3,\"tx_bytes\":4,\"tx_packets\":5,\"tx_errors\":6,"
+                       "\"tx_drops\":7,\"elapsed\":null") != NULL);
+    CHECK(strstr(rows, "\"interface\":\"veth300\",\"rx_bytes\":42,") != NULL);
+    free(rows);
+    free(errors);
+}
+
+static bool is_boundary(size_t len) {
+    for (size_t i = 0; i < boundary_count; i++) {
+        if (boundaries[i] == len) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Cut the capture at every length: only cuts between records decode
+ * An interface record and its first sample are written together, so the
+ * cut between the two is also clean
+ */
+static void test_truncated(void) {
+    size_t size = write_capture();
+    uint8_t *bytes = malloc(size);
+    int fd = open(path, O_RDONLY);
+    CHECK(bytes && fd >= 0 && read(fd, bytes, size) == (ssize_t)size);
+    close(fd);
+
+    for (size_t len = 0; len < size; len++) {
+        char *rows, *errors;
+        bool clean = is_boundary(len);
+        for (size_t b = 0; b + 1 < boundary_count && !clean; b++) {
+            const uint8_t *record = bytes + boundaries[b];
+            if (record[0] == RECORD_IFACE) {
+                size_t id_len = record[1] & 0x80 ? 2 : 1;
+                clean = len == boundaries[b] + 2 + id_len + record[1 + id_len];
+            }
+        }
+
+        write_bytes(bytes, len, false);
+        bool ok = decode(&rows, &errors);
+        if (len < RECORD_HEADER_SIZE) {
+            CHECK(!ok && strstr(errors, "is not a netstat_monitor binary capture") != NULL);
+        } else {
+            CHECK(ok == clean);
+            CHECK(ok || strstr(errors, "is truncated or corrupt") != NULL);
+        }
+        free(rows);
+        free(errors);
+    }
+    free(bytes);
+}
+
+/**
+ * A capture holding the header and then raw bytes decodes as expected
+ */
+static void check_records(const uint8_t *records, size_t len, bool expect_ok,
+                          const char *expect_error) {
+    record_state_t state = {0};
+    output_t out;
+    struct timespec start;
+    char *rows, *errors;
+
+    int fd = open(path, O_WRONLY | O_TRUNC);
+    CHECK(fd >= 0 && output_init(&out, fd, 0));
+    at(&start, 0, 0);
+    record_write_header(&state, &out, NSEC_PER_SEC, &start);
+    CHECK(output_flush(&out));
+    output_free(&out);
+    record_state_free(&state);
+    close(fd);
+    write_bytes(records, len, true);
+
+    bool ok = decode(&rows, &errors);
+    CHECK(ok == expect_ok);
+    CHECK(!expect_error || strstr(errors, expect_error) != NULL);
+    free(rows);
+    free(errors);
+}
+
+static void test_corrupt(void) {
+    uint8_t records[MAX_IFACE_LEN + 16];
+    size_t n;
+
+    check_records(NULL, 0, true, NULL);
+
+    /* Unknown tag */
+    records[0] = 9;
+    records[1] = 0;
+    check_records(records, 2, false, "truncated or corrupt");
+
+    /* A sample for an interface never named */
+    memset(records, 0, sizeof(records));
+    records[0] = RECORD_SAMPLE;
+    check_records(records, 11, false, "truncated or corrupt");
+
+    /* Ids a writer never produces, including one past 2^63 */
+    records[0] = RECORD_IFACE;
+    n = 1 + put_varint(records + 1, UINT64_C(1) << 60);
+    records[n++] = 1;
+    records[n++] = 'x';
+    check_records(records, n, false, "truncated or corrupt");
+    n = 1 + put_varint(records + 1, (UINT64_C(1) << 63) + 1);
+    records[n++] = 1;
+    records[n++] = 'x';
+    check_records(records, n, false, "truncated or corrupt");
+
+    /* Ids just past the bound, and one that once cost gigabytes of state */
+    records[0] = RECORD_GONE;
+    n = 1 + put_varint(records + 1, RECORD_MAX_ID + UINT64_C(1));
+    check_records(records, n, false, "truncated or corrupt");
+    n = 1 + put_varint(records + 1, UINT64_C(1) << 24);
+    check_records(records, n, false, "truncated or corrupt");
+
+    /* A varint longer than 64 bits */
+    records[0] = RECORD_GONE;
+    memset(records + 1, 0x80, 10);
+    records[11] = 0;
+    check_records(records, 12, false, "truncated or corrupt");
+
+    /* A name too long for an interface */
+    records[0] = RECORD_IFACE;
+    records[1] = 0;
+    records[2] = MAX_IFACE_LEN;
+    memset(records + 3, 'a', MAX_IFACE_LEN);
+    check_records(records, 3 + MAX_IFACE_LEN - 1, false, "truncated or corrupt");
+    records[2] = MAX_IFACE_LEN - 1;
+    check_records(records, 3 + MAX_IFACE_LEN - 1, true, NULL);
+}
+
+static void test_bad_header(void) {
+    uint8_t header[RECORD_HEADER_SIZE] = {'N', 'S', 'M', 'B', RECORD_VERSION, 0,
+                                          RECORD_HEADER_SIZE, 0};
+    char *rows, *errors;
+
+    write_bytes(header, sizeof(header), false);
+    CHECK(decode(&rows, &errors));
+    free(rows);
+    free(errors);
+
+    header[4] = RECORD_VERSION + 1;
+    write_bytes(header, sizeof(header), false);
+    CHECK(!decode(&rows, &errors));
+    CHECK(strstr(errors, "is not a netstat_monitor binary capture") != NULL);
+    free(rows);
+    free(errors);
+
+    header[4] = RECORD_VERSION;
+    header[6] = RECORD_HEADER_SIZE - 1;
+    write_bytes(header, sizeof(header), false);
+    CHECK(!decode(&rows, &errors));
+    CHECK(strstr(errors, "has a malformed header") != NULL);
+    free(rows);
+    free(errors);
+
+    header[0] = 'X';
+    header[6] = RECORD_HEADER_SIZE;
+    write_bytes(header, sizeof(header), false);
+    CHECK(!decode(&rows, &errors));
+    CHECK(strstr(errors, "is not a netstat_monitor binary capture") != NULL);
+    free(rows);
+    free(errors);
+}
+
+int main(void) {
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        perror("mkstemp");
+        return EXIT_FAILURE;
+    }
+    close(fd);
+
+    test_round_trip();
+    test_truncated();
+    test_corrupt();
+    test_bad_header();
+
+    unlink(path);
+    return test_summary("test_record");
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2025 Mohamed Elmoncef HAMDI
+ * This file is part of netstat-monitor <https://github.com/moncef007/netstat-monitor>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "netstat_monitor.h"
+#include "iface_soa.h"
+#include "shm_stats.h"
+
+#define IFACES 3
+#define PUBLISHES 20000
+
+static void fill_view(iface_soa_t *view, uint64_t value, int64_t time_ns) {
+    for (size_t i = 0; i < view->count; i++) {
+        for (int c = 0; c < IFACE_COUNTERS; c++) {
+            view->current[c][i] = value;
+        }
+        view->time_ns[i] = time_ns;
+        view->seen[i] = 1;
+    }
+}
+
+static void init_view(iface_soa_t *view) {
+    memset(view, 0, sizeof(*view));
+    CHECK(iface_soa_add(view, "eth0", 4));
+    CHECK(iface_soa_add(view, "eth1", 4));
+    CHECK(iface_soa_add(view, "lo", 2));
+}
+
+static void bump(_Atomic uint64_t *seq) {
+    atomic_fetch_add(seq, 1);
+}
+
+typedef struct {
+    shm_stats_t *shm;
+    iface_soa_t *view;
+    atomic_bool done;
+} writer_t;
+
+static void *publish_loop(void *arg) {
+    writer_t *writer = arg;
+    for (uint64_t i = 1; i <= PUBLISHES; i++) {
+        struct timespec wall = {.tv_sec = (time_t)i};
+        fill_view(writer->view, i, (int64_t)i);
+        shm_stats_publish(writer->shm, writer->view, &wall);
+    }
+    atomic_store(&writer->done, true);
+    return NULL;
+}
+
+/**
+ * An odd seq reads as busy, with the pid of the writer to tell a live
+ * one from a dead one; snapshots taken while the writer runs are never
+ * torn
+ */
+static void test_shm(void) {
+    char name[64];
+    iface_soa_t view;
+    shm_stats_t shm;
+    shm_stats_reader_t reader;
+    shm_stats_entry_t entries[IFACES];
+    shm_stats_info_t info;
+
+    snprintf(name, sizeof(name), "/netstat_monitor_test_%ld", (long)getpid());
+    init_view(&view);
+    CHECK(shm_stats_create(&shm, name, NSEC_PER_SEC, IFACES));
+    CHECK(shm_stats_open(&reader, name));
+    CHECK(shm_stats_capacity(&reader) == IFACES);
+    CHECK(shm_stats_read(&reader, entries, IFACES, &info) == SHM_STATS_EMPTY);
+
+    struct timespec wall = {.tv_sec = 1700000000};
+    fill_view(&view, 7, 0);
+    shm_stats_publish(&shm, &view, &wall);
+    CHECK(shm_stats_read(&reader, entries, IFACES, &info) == SHM_STATS_OK);
+    CHECK(info.count == IFACES && info.tick == 1 && info.pid == (int64_t)getpid());
+    CHECK(strcmp(entries[2].current.interface, "lo") == 0);
+    CHECK(entries[2].current.rx_bytes == 7 && entries[2].current.valid);
+
+    shm_stats_header_t *header = shm.map;
+    bump(&header->seq);
+    CHECK(shm_stats_read(&reader, entries, IFACES, &info) == SHM_STATS_BUSY);
+    CHECK(info.pid == (int64_t)getpid());
+    CHECK(shm_stats_writer_alive(info.pid));
+    bump(&header->seq);
+    CHECK(shm_stats_read(&reader, entries, IFACES, &info) == SHM_STATS_OK);
+
+    writer_t writer = {.shm = &shm, .view = &view};
+    pthread_t thread;
+    size_t snapshots = 0;
+    CHECK(pthread_create(&thread, NULL, publish_loop, &writer) == 0);
+    while (!atomic_load(&writer.done)) {
+        if (shm_stats_read(&reader, entries, IFACES, &info) != SHM_STATS_OK) {
+            continue;
+        }
+        /* The first tick is the one published above */
+        uint64_t expected = info.tick - 1;
+        for (size_t i = 0; i < info.count && expected; i++) {
+            CHECK(entries[i].current.rx_bytes == expected);
+            CHECK(entries[i].current.tx_drops == expected);
+            CHECK((uint64_t)entries[i].current.timestamp.tv_nsec == expected);
+        }
+        CHECK(expected == 0 || info.time_ns == expected * NSEC_PER_SEC);
+        snapshots++;
+    }
+    pthread_join(thread, NULL);
+    CHECK(snapshots > 0);
+
+    shm_stats_close(&reader);
+    shm_stats_destroy(&shm);
+    iface_soa_free(&view);
+}
+
+int main(void) {
+    test_shm();
+    return test_summary("test_shm");
+}